@@ -0,0 +1,287 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: benchmark harness. Runs the workloads in bench/ and reports timings and memory usage as JSON.             *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <vector>
+#include <phon/runtime/runtime.hpp>
+#include <phon/runtime/file.hpp>
+#include <phon/utils/file_system.hpp>
+#include <phon/utils/helpers.hpp>
+
+#if PHON_WINDOWS
+#	include <windows.h>
+#	include <psapi.h>
+#elif !defined(__linux__)
+#	include <sys/resource.h>
+#endif
+
+using namespace phonometrica;
+
+// Count heap allocations made through operator new. The runtime's own allocations, which go through utils::alloc(), are
+// counted by its memory tracker.
+static std::atomic<intptr_t> allocation_count(0);
+static std::atomic<intptr_t> allocated_bytes(0);
+
+void *operator new(size_t size)
+{
+	allocation_count.fetch_add(1, std::memory_order_relaxed);
+	allocated_bytes.fetch_add(intptr_t(size), std::memory_order_relaxed);
+
+	if (auto ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+	std::free(ptr);
+}
+
+struct Result
+{
+	String name;
+	std::vector<double> times; // in milliseconds
+	intptr_t allocations = 0;
+	intptr_t bytes = 0;
+	intptr_t peak_rss = 0; // in kilobytes
+};
+
+// Reset the peak resident set size, if the system allows it, so that it can be measured for each workload.
+static void reset_peak_rss()
+{
+#ifdef __linux__
+	if (auto f = fopen("/proc/self/clear_refs", "w"))
+	{
+		fputs("5", f);
+		fclose(f);
+	}
+#endif
+}
+
+static intptr_t get_peak_rss()
+{
+#if PHON_WINDOWS
+	PROCESS_MEMORY_COUNTERS info;
+	GetProcessMemoryInfo(GetCurrentProcess(), &info, sizeof(info));
+	return intptr_t(info.PeakWorkingSetSize / 1024);
+#elif defined(__linux__)
+	// ru_maxrss is not affected by clear_refs, but VmHWM is.
+	intptr_t peak = 0;
+	if (auto f = fopen("/proc/self/status", "r"))
+	{
+		char line[256];
+		while (fgets(line, sizeof line, f))
+		{
+			if (strncmp(line, "VmHWM:", 6) == 0)
+			{
+				peak = atol(line + 6);
+				break;
+			}
+		}
+		fclose(f);
+	}
+	return peak;
+#else
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#	ifdef __APPLE__
+	return intptr_t(usage.ru_maxrss / 1024);
+#	else
+	return intptr_t(usage.ru_maxrss);
+#	endif
+#endif
+}
+
+static double percentile(std::vector<double> values, double p)
+{
+	std::sort(values.begin(), values.end());
+	auto rank = p * double(values.size() - 1);
+	auto i = size_t(rank);
+	auto j = (std::min)(i + 1, values.size() - 1);
+
+	return values[i] + (values[j] - values[i]) * (rank - double(i));
+}
+
+static Result run_workload(Runtime &rt, const String &path, int runs)
+{
+	Result result;
+	result.name = filesystem::strip_ext(filesystem::base_name(path));
+	reset_peak_rss();
+
+	for (int i = 0; i < runs; i++)
+	{
+		auto &usage = rt.memory_stats()->total();
+		auto count = allocation_count.load() + usage.allocations;
+		auto bytes = allocated_bytes.load() + usage.allocated_bytes;
+		auto start = std::chrono::steady_clock::now();
+		rt.do_file(path);
+		auto end = std::chrono::steady_clock::now();
+		rt.reset_globals();
+
+		// Allocations don't vary between runs: keep the last one.
+		result.allocations = allocation_count.load() + usage.allocations - count;
+		result.bytes = allocated_bytes.load() + usage.allocated_bytes - bytes;
+		result.times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+	}
+	result.peak_rss = get_peak_rss();
+
+	return result;
+}
+
+// Find the median time of a workload in a file previously written by phon-bench, which has one workload per line.
+static double find_baseline(const String &baseline, const String &name)
+{
+	auto key = String::format("\"name\": \"%s\",", name.data());
+	auto pos = strstr(baseline.data(), key.data());
+	if (!pos) return 0;
+	auto median = strstr(pos, "\"median_ms\": ");
+	auto eol = strchr(pos, '\n');
+	if (!median || (eol && median > eol)) return 0;
+
+	return atof(median + strlen("\"median_ms\": "));
+}
+
+static void write_json(FILE *out, const std::vector<Result> &results, int runs, const String &baseline)
+{
+	fprintf(out, "{\n\"runs\": %d,\n\"workloads\": [\n", runs);
+
+	for (size_t i = 0; i < results.size(); i++)
+	{
+		auto &r = results[i];
+		auto median = percentile(r.times, 0.5);
+		fprintf(out, "{\"name\": \"%s\", \"median_ms\": %.3f, \"p95_ms\": %.3f, \"min_ms\": %.3f, \"allocations\": %ld, "
+			   "\"allocated_bytes\": %ld, \"peak_rss_kb\": %ld", r.name.data(), median, percentile(r.times, 0.95),
+			   *std::min_element(r.times.begin(), r.times.end()), long(r.allocations), long(r.bytes), long(r.peak_rss));
+
+		if (!baseline.empty())
+		{
+			auto base = find_baseline(baseline, r.name);
+			if (base > 0) {
+				fprintf(out, ", \"baseline_median_ms\": %.3f, \"speedup\": %.3f", base, base / median);
+			}
+		}
+		fprintf(out, "}%s\n", (i + 1 < results.size()) ? "," : "");
+	}
+	fprintf(out, "]\n}\n");
+}
+
+static void usage()
+{
+	std::cout << "Usage: phon-bench [options] [file or directory...]" << std::endl;
+	std::cout << "Run each workload several times and report the median and 95th percentile times, the number of" << std::endl;
+	std::cout << "allocations and the peak resident set size as JSON. By default, all the scripts in " << PHON_BENCH_DIR << " are run." << std::endl;
+	std::cout << "Options: " << std::endl;
+	std::cout << " -n runs\tnumber of runs per workload (default: 5)" << std::endl;
+	std::cout << " -o file\twrite the results to file instead of the standard output" << std::endl;
+	std::cout << " -c file\tcompare median times to the results of a previous run" << std::endl;
+}
+
+int main(int argc, char *argv[])
+{
+	int runs = 5;
+	String output, baseline_path;
+	std::vector<String> paths;
+
+	for (int i = 1; i < argc; i++)
+	{
+		String arg(argv[i]);
+
+		if ((arg == "-n" || arg == "-o" || arg == "-c") && i + 1 < argc)
+		{
+			String value(argv[++i]);
+			if (arg == "-n") runs = (std::max)(1, atoi(value.data()));
+			else if (arg == "-o") output = value;
+			else baseline_path = value;
+		}
+		else if (arg == "-h" || arg == "--help")
+		{
+			usage();
+			return 0;
+		}
+		else
+		{
+			paths.push_back(arg);
+		}
+	}
+	if (paths.empty()) {
+		paths.emplace_back(PHON_BENCH_DIR);
+	}
+
+	try
+	{
+		std::vector<String> files;
+
+		for (auto &path : paths)
+		{
+			if (filesystem::is_directory(path))
+			{
+				for (auto &name : filesystem::list_directory(path))
+				{
+					if (name.ends_with(".calao")) {
+						files.push_back(filesystem::join(path, name));
+					}
+				}
+			}
+			else
+			{
+				files.push_back(path);
+			}
+		}
+		std::sort(files.begin(), files.end());
+
+		String baseline;
+		if (!baseline_path.empty()) {
+			baseline = File::read_all(baseline_path);
+		}
+
+		// Built-in classes are registered globally, so there can only be one runtime per process.
+		Runtime rt;
+		rt.enable_memory_stats();
+		std::vector<Result> results;
+		for (auto &file : files)
+		{
+			std::cerr << "Running " << file << "..." << std::endl;
+			results.push_back(run_workload(rt, file, runs));
+		}
+
+		FILE *out = stdout;
+		if (!output.empty() && !(out = utils::open_file(output, "w"))) {
+			throw error("Cannot open file \"%\"", output);
+		}
+		write_json(out, results, runs, baseline);
+		if (out != stdout) fclose(out);
+	}
+	catch (RuntimeError &e) {
+		std::cerr << "Line " << e.line_no() << ": " << e.what() << std::endl;
+		return 1;
+	}
+	catch (std::exception &e) {
+		std::cerr << e.what() << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
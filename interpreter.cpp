@@ -37,6 +37,43 @@ int main(int argc, char *argv[])
 			{
 				rt.do_file(path);
 			}
+			else if (option == "-p") // profile
+			{
+				String output(argc > 3 ? argv[3] : argv[2]);
+				if (argc <= 3) output.append(".folded");
+				rt.start_profiler();
+				rt.do_file(path);
+				auto profiler = rt.stop_profiler();
+				std::cerr << profiler->report();
+				profiler->write_collapsed_stacks(output);
+				std::cerr << "\nCollapsed stacks written to " << output << std::endl;
+			}
+			else if (option == "-s") // statistics
+			{
+				rt.start_opcode_stats();
+				rt.do_file(path);
+				std::cerr << rt.stop_opcode_stats()->report();
+			}
+			else if (option == "-m") // memory
+			{
+				if (argc > 3) {
+					rt.set_memory_limit(intptr_t(atof(argv[3]) * 1024 * 1024));
+				}
+				else {
+					rt.enable_memory_stats();
+				}
+				rt.do_file(path);
+				auto stats = rt.memory_stats();
+				fprintf(stderr, "%-10s %12s %12s %12s %14s\n", "Category", "Blocks", "Bytes", "Allocations", "Allocated");
+				for (size_t i = 0; i < utils::MEMORY_CATEGORY_COUNT; i++)
+				{
+					auto category = static_cast<utils::MemoryCategory>(i);
+					auto &usage = stats->usage(category);
+					fprintf(stderr, "%-10s %12ld %12ld %12ld %14ld\n", utils::MemoryTracker::get_category_name(category),
+							long(usage.blocks), long(usage.bytes), long(usage.allocations), long(usage.allocated_bytes));
+				}
+				fprintf(stderr, "\nPeak memory usage: %ld bytes\n", long(stats->peak()));
+			}
 			else if (option == "-a") // all
 			{
 				auto closure = rt.compile_file(path);
@@ -65,6 +102,11 @@ int main(int argc, char *argv[])
 			std::cout << " -l\t(list)\tlist bytecode (disassemble) file" << std::endl;
 			std::cout << " -r\t(run)\texecute file" << std::endl;
 			std::cout << " -a\t(all)\tdisassemble and execute file" << std::endl;
+			std::cout << " -p\t(profile)\texecute file and report hot spots; collapsed stacks are written to the optional" << std::endl;
+			std::cout << "\t\t\tthird argument or to file.folded" << std::endl;
+			std::cout << " -s\t(statistics)\texecute file and report opcode and opcode pair counts" << std::endl;
+			std::cout << " -m\t(memory)\texecute file and report memory usage; the optional third argument is a memory limit" << std::endl;
+			std::cout << "\t\t\tin megabytes" << std::endl;
 		}
 
 	}
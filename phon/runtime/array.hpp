@@ -18,6 +18,8 @@
 #define PHONOMETRICA_ARRAY_HPP
 
 #include <algorithm>
+#include <limits>
+#include <new>
 #include <vector>
 #include <type_traits>
 #include <phon/error.hpp>
@@ -79,14 +81,10 @@ public:
 		switch (ndim())
 		{
 			case 1:
-			{
-				m_dim.d1.capacity = other.m_dim.d1.capacity;
-				break;
-			}
 			case 2:
 			{
-				m_dim.d2.nrow = other.nrow();
-				m_dim.d2.ncol = other.ncol();
+				// Copy the whole union so that no member is left uninitialized.
+				m_dim = other.m_dim;
 				break;
 			}
 			default:
@@ -98,7 +96,7 @@ public:
 		}
 
 		auto count = (ndim() == 1) ? capacity() : size();
-		m_data = utils::allocate<value_type>(count);
+		m_data = utils::allocate<value_type>(count, utils::MemoryCategory::Arrays);
 		std::copy(other.begin(), other.end(), this->begin());
 	}
 
@@ -139,7 +137,7 @@ public:
 		m_ndim = 1;
 		m_size = 0;
 		m_dim.d1.capacity = capacity;
-		m_data = utils::allocate<value_type>(capacity);
+		m_data = utils::allocate<value_type>(capacity, utils::MemoryCategory::Arrays);
 	}
 
 	Array(std::span<T> span) :
@@ -224,12 +222,12 @@ public:
 				value.~value_type();
 			}
 
-			utils::free(m_data);
+			utils::free(m_data, utils::MemoryCategory::Arrays);
 
 			if (ndim() > 2)
 			{
-				utils::free(this->shape());
-				utils::free(this->jumps());
+				utils::free(this->shape(), utils::MemoryCategory::Arrays);
+				utils::free(this->jumps(), utils::MemoryCategory::Arrays);
 			}
 		}
 	}
@@ -950,8 +948,8 @@ private:
 
 	void alloc_dims(size_type n)
 	{
-		m_dim.dx.shape = reinterpret_cast<size_type*>(utils::alloc(sizeof(size_type) * n));
-		m_dim.dx.jumps = reinterpret_cast<size_type*>(utils::alloc(sizeof(size_type) * n));
+		m_dim.dx.shape = reinterpret_cast<size_type*>(utils::alloc(sizeof(size_type) * n, utils::MemoryCategory::Arrays));
+		m_dim.dx.jumps = reinterpret_cast<size_type*>(utils::alloc(sizeof(size_type) * n, utils::MemoryCategory::Arrays));
 	}
 
     void zero()
@@ -970,16 +968,21 @@ private:
 
 		if (requested > capacity())
 		{
+			// The capacity may grow up to twice the requested size, and its size in bytes must fit in an intptr_t.
+			if (requested > (std::numeric_limits<size_type>::max)() / intptr_t(sizeof(value_type)) / 2) {
+				throw std::bad_alloc();
+			}
 			auto previous_capacity = (std::max<size_type>)(this->capacity(), 8);
 			auto capacity = utils::find_capacity(requested, previous_capacity);
-			m_dim.d1.capacity = capacity;
 
+			// Only update the capacity once the allocation has succeeded.
 			if (m_data) {
-				m_data = utils::reallocate<value_type>(m_data, size(), capacity);
+				m_data = utils::reallocate<value_type>(m_data, size(), capacity, utils::MemoryCategory::Arrays);
 			}
 			else {
-				m_data = utils::allocate<value_type>(capacity);
+				m_data = utils::allocate<value_type>(capacity, utils::MemoryCategory::Arrays);
 			}
+			m_dim.d1.capacity = capacity;
 
 			return true;
 		}
@@ -1027,7 +1030,7 @@ private:
 
 	void alloc_data_ndim(size_type count, const value_type &default_value = value_type())
 	{
-		m_data = utils::allocate<value_type>(count);
+		m_data = utils::allocate<value_type>(count, utils::MemoryCategory::Arrays);
 
 		// Scalar types are already 0-initialized by calloc(), so we don't need to do anything for them.
 		if (!has_scalar_type || default_value != 0) {
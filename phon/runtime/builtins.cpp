@@ -18,7 +18,9 @@
 #include <phon/runtime/func_list.hpp>
 #include <phon/runtime/func_table.hpp>
 #include <phon/runtime/func_regex.hpp>
+#include <phon/runtime/func_matcher.hpp>
 #include <phon/runtime/func_set.hpp>
+#include <phon/runtime/func_range.hpp>
 #include <phon/runtime/func_math.hpp>
 #include <phon/runtime/func_array.hpp>
 #include <phon/runtime/func_module.hpp>
@@ -59,6 +61,8 @@ void Runtime::set_global_namespace()
 	// Generic functions
 	add_global("type", get_type, { CLS(Object) });
 	add_global("len", get_length, { CLS(Object) });
+	add_global("with_capacity", with_capacity, { CLS(Class), CLS(intptr_t) });
+	add_global("catch_error", catch_error, { CLS(Function) });
 	add_global("str", to_string, { CLS(Object) });
 	add_global("bool", to_boolean, { CLS(Object) });
 	add_global("int", to_integer, { CLS(Object) });
@@ -105,7 +109,7 @@ void Runtime::set_global_namespace()
 	add_global("sin", math_sin, { CLS(Number) });
 	add_global("sin", math_array_func<std::sin>, { CLS(Array<double>) });
 	add_global("sqrt", math_sqrt, { CLS(Number) });
-	add_global("sqrt", math_array_func<std::sqrt>, { CLS(Array<double>) });
+	add_global("sqrt", array_sqrt, { CLS(Array<double>) });
 	add_global("tan", math_tan, { CLS(Number) });
 	add_global("tan", math_array_func<std::tan>, { CLS(Array<double>) });
 	add_global("E", 2.7182818284590452354);
@@ -132,6 +136,7 @@ void Runtime::set_global_namespace()
 	add_global("is_empty", string_is_empty, {CLS(String)});
 	add_global("char", string_char, { CLS(String), CLS(intptr_t) });
 	add_global("split", string_split, { CLS(String), CLS(String) });
+	add_global("split", string_split_regex, { CLS(String), CLS(Regex) });
 	add_global("append", string_append, { CLS(String), CLS(String) }, REF("01"));
 	add_global("prepend", string_prepend, { CLS(String), CLS(String) }, REF("01"));
 	add_global("insert", string_insert, { CLS(String), CLS(intptr_t), CLS(String) }, REF("001"));
@@ -143,7 +148,9 @@ void Runtime::set_global_namespace()
 	add_global("remove_last", string_remove_last, {CLS(String), CLS(String)}, REF("01"));
 	add_global("remove_at", string_remove_at, {CLS(String), CLS(intptr_t), CLS(intptr_t)}, REF("001"));
 	add_global("replace", string_replace, { CLS(String), CLS(String), CLS(String) }, REF("001"));
+	add_global("replace", string_replace_regex, { CLS(String), CLS(Regex), CLS(String) }, REF("001"));
 	add_global("replace_first", string_replace_first, {CLS(String), CLS(String), CLS(String)}, REF("001"));
+	add_global("replace_first", string_replace_first_regex, {CLS(String), CLS(Regex), CLS(String)}, REF("001"));
 	add_global("replace_last", string_replace_last, {CLS(String), CLS(String), CLS(String)}, REF("001"));
 	add_global("replace_at", string_replace_at, {CLS(String), CLS(intptr_t), CLS(intptr_t), CLS(String)}, REF("0001"));
 	auto string_class = Class::get<String>();
@@ -164,10 +171,15 @@ void Runtime::set_global_namespace()
 	add_global("clear", list_clear, { CLS(List) }, REF("1"));
 	add_global("append", list_append, {CLS(List), CLS(Object)}, REF("01"));
 	add_global("prepend", list_prepend, {CLS(List), CLS(Object)}, REF("01"));
+	add_global("extend", list_extend, {CLS(List), CLS(List)}, REF("01"));
+	add_global("reserve", list_reserve, {CLS(List), CLS(intptr_t)}, REF("01"));
 	add_global("is_empty", list_is_empty, {CLS(List)});
 	add_global("pop", list_pop, { CLS(List) }, REF("1"));
 	add_global("shift", list_shift, { CLS(List) }, REF("1"));
-	add_global("sort", list_sort, { CLS(List) }, REF("1"));
+	add_global("sort", list_sort1, { CLS(List) }, REF("1"));
+	add_global("sort", list_sort2, { CLS(List), CLS(Function) }, REF("01"));
+	add_global("stable_sort", list_stable_sort1, { CLS(List) }, REF("1"));
+	add_global("stable_sort", list_stable_sort2, { CLS(List), CLS(Function) }, REF("01"));
 	add_global("sorted_find", list_sorted_find, { CLS(List), CLS(Object) });
 	add_global("sorted_insert", list_sorted_insert, { CLS(List), CLS(Object) }, REF("01"));
 	add_global("is_sorted", list_is_sorted, { CLS(List) });
@@ -194,7 +206,10 @@ void Runtime::set_global_namespace()
 	add_global("read_line", file_read_line, { CLS(File) });
 	add_global("read_lines", file_read_lines, { CLS(File) });
 	add_global("write_line", file_write_line, {CLS(File), CLS(String) });
-	add_global("write_lines", file_write_lines, {CLS(File), CLS(List) });
+	add_global("write_lines", file_write_lines1, {CLS(File), CLS(List) });
+	add_global("write_lines", file_write_lines2, {CLS(File), CLS(List), CLS(String) });
+	add_global("flush", file_flush, {CLS(File) });
+	add_global("set_buffer_size", file_set_buffer_size, {CLS(File), CLS(intptr_t) });
 	add_global("write", file_write, {CLS(File), CLS(String) });
 	add_global("close", file_close, {CLS(File) });
 	add_global("read", file_read, {CLS(File)});
@@ -215,6 +230,7 @@ void Runtime::set_global_namespace()
 	add_global("remove", table_remove, { CLS(Table), CLS(Object) }, REF("01"));
 	add_global("get", table_get1, { CLS(Table), CLS(Object) });
 	add_global("get", table_get2, { CLS(Table), CLS(Object), CLS(Object) });
+	add_global("reserve", table_reserve, { CLS(Table), CLS(intptr_t) }, REF("01"));
 	auto table_class = Class::get<Table>();
 	table_class->add_initializer(table_init, { });
 	table_class->add_method(get_item_string, table_get_item, { CLS(Table), CLS(Object) });
@@ -228,6 +244,22 @@ void Runtime::set_global_namespace()
 	add_global("ones", array_ones2, { CLS(intptr_t), CLS(intptr_t) });
 	add_global("min", array_min, { CLS(Array<double>) });
 	add_global("max", array_max, { CLS(Array<double>) });
+	add_global("argmin", array_argmin, { CLS(Array<double>) });
+	add_global("argmax", array_argmax, { CLS(Array<double>) });
+	add_global("sum", array_sum, { CLS(Array<double>) });
+	add_global("mean", array_mean, { CLS(Array<double>) });
+	add_global("variance", array_variance, { CLS(Array<double>) });
+	add_global("dot", array_dot, { CLS(Array<double>), CLS(Array<double>) });
+	add_global("cumsum", array_cumsum, { CLS(Array<double>) });
+	add_global("matmul", array_matmul, { CLS(Array<double>), CLS(Array<double>) });
+	add_global("transpose", array_transpose, { CLS(Array<double>) });
+	add_global("get_row", array_get_row, { CLS(Array<double>), CLS(intptr_t) });
+	add_global("get_column", array_get_column, { CLS(Array<double>), CLS(intptr_t) });
+	add_global("reshape", array_reshape, { CLS(Array<double>), CLS(intptr_t), CLS(intptr_t) });
+	add_global("row_sums", array_row_sums, { CLS(Array<double>) });
+	add_global("column_sums", array_column_sums, { CLS(Array<double>) });
+	add_global("row_means", array_row_means, { CLS(Array<double>) });
+	add_global("column_means", array_column_means, { CLS(Array<double>) });
 	add_global("clear", array_clear, { CLS(Array<double>) }, REF("1"));
 	auto array_class = Class::get<Array<double>>();
 	auto &zeros = (*globals)["zeros"];
@@ -250,6 +282,27 @@ void Runtime::set_global_namespace()
 	add_global("group", regex_group, { CLS(Regex), CLS(intptr_t) });
 	add_global("get_start", regex_get_start, {CLS(Regex), CLS(intptr_t)});
 	add_global("get_end", regex_get_end, {CLS(Regex), CLS(intptr_t)});
+	add_global("find_all", regex_find_all, {CLS(Regex), CLS(String)});
+	add_global("regex_cache_stats", regex_cache_stats, {});
+	add_global("set_regex_cache_capacity", regex_set_cache_capacity, {CLS(intptr_t)});
+	add_global("set_regex_jit_stack_size", regex_set_jit_stack_size, {CLS(intptr_t)});
+	auto match_class = Class::get<Match>();
+	match_class->add_method(get_field_string, match_get_field, {CLS(Match), CLS(String)});
+	add_global("count", match_count, { CLS(Match) });
+	add_global("group", match_group, { CLS(Match), CLS(intptr_t) });
+	add_global("get_start", match_get_start, {CLS(Match), CLS(intptr_t)});
+	add_global("get_end", match_get_end, {CLS(Match), CLS(intptr_t)});
+
+	// Matcher
+	auto matcher_class = Class::get<Matcher>();
+	matcher_class->add_initializer(matcher_new1, {CLS(List)});
+	matcher_class->add_initializer(matcher_new2, {CLS(List), CLS(String)});
+	matcher_class->add_method(get_field_string, matcher_get_field, {CLS(Matcher), CLS(String)});
+	add_global("find_all", matcher_find_all, {CLS(Matcher), CLS(String)});
+	add_global("count", matcher_count, {CLS(Matcher), CLS(String)});
+	add_global("contains", matcher_contains, {CLS(Matcher), CLS(String)});
+	add_global("replace", matcher_replace1, {CLS(String), CLS(Matcher), CLS(String)}, REF("001"));
+	add_global("replace", matcher_replace2, {CLS(String), CLS(Matcher), CLS(List)}, REF("001"));
 
 	// Set
 	add_global("contains", set_contains, { CLS(Set), CLS(Object) });
@@ -264,6 +317,18 @@ void Runtime::set_global_namespace()
 	set_class->add_initializer(set_init, {});
 	set_class->add_method(get_field_string, set_get_field, { CLS(Set), CLS(String) });
 
+	// Range
+	add_global("range", range_new2, { CLS(intptr_t), CLS(intptr_t) });
+	add_global("range", range_new3, { CLS(intptr_t), CLS(intptr_t), CLS(intptr_t) });
+	add_global("contains", range_contains, { CLS(Range), CLS(Object) });
+	add_global("is_empty", range_is_empty, { CLS(Range) });
+	auto range_class = Class::get<Range>();
+	range_class->add_initializer(range_new2, { CLS(intptr_t), CLS(intptr_t) });
+	range_class->add_initializer(range_new3, { CLS(intptr_t), CLS(intptr_t), CLS(intptr_t) });
+	range_class->add_method(get_item_string, range_get_item, { CLS(Range), CLS(intptr_t) });
+	range_class->add_method(get_field_string, range_get_field, { CLS(Range), CLS(String) });
+	list_class->add_initializer(range_to_list, { CLS(Range) });
+
 	// System functions
 	add_global("get_user_directory", system_user_directory, {});
 	add_global("get_current_directory", system_current_directory, {});
@@ -271,6 +336,8 @@ void Runtime::set_global_namespace()
 	add_global("get_temp_directory", system_temp_directory, {});
 	add_global("get_path_separator", system_separator, {});
 	add_global("get_system_name", system_name, {});
+	add_global("memory_stats", system_memory_stats, {});
+	add_global("enable_memory_stats", system_enable_memory_stats, {});
 	add_global("get_full_path", system_full_path, { CLS(String) });
 	add_global("join_path", system_join, { CLS(String), CLS(String) });
 	add_global("get_temp_name", system_temp_name, {});
@@ -23,6 +23,7 @@
 #include <phon/runtime/function.hpp>
 #include <phon/dictionary.hpp>
 #include <phon/runtime/variant_def.hpp>
+#include <phon/utils/alloc.hpp>
 
 namespace phonometrica {
 
@@ -43,10 +44,13 @@ public:
 		Float,
 		String,
 		Regex,
+		Match,
+		Matcher,
 		List,
 		Array,
 		Table,
 		Set,
+		Range,
 		File,
 		Function,
 		Closure,
@@ -57,6 +61,7 @@ public:
 		StringIterator,
 		FileIterator,
 		RegexIterator,
+		RangeIterator,
 		Foreign
 	};
 
@@ -110,6 +115,9 @@ public:
 
 	void traverse_members(const GCCallback &callback);
 
+	// Memory used by instances of this class. This is only updated while memory is being accounted for.
+	const utils::MemoryUsage &memory_usage() const { return memory; }
+
 private:
 
 	friend class Runtime;
@@ -150,6 +158,8 @@ private:
 
 	Dictionary<Variant> members;
 
+	utils::MemoryUsage memory;
+
 	// For debugging.
 	Index index;
 
@@ -92,46 +92,41 @@ const char *opcode_names[] = {
 	"SetUpvalue",
 	"Subtract",
 	"TestIterator",
-	"Throw"
+	"Throw",
+	"Wide"
 };
 
+static_assert(sizeof(opcode_names) / sizeof(opcode_names[0]) == OPCODE_COUNT);
+
 void Code::add_line(intptr_t line_no)
 {
-	constexpr auto max_lines = (std::numeric_limits<uint16_t>::max)();
-
-	if (unlikely(line_no > max_lines)) {
-		throw error("Source file too long: a file can contain at most % lines", max_lines);
-	}
-
-	if (lines.empty() || lines.back().first != line_no)
+	if (lines.empty() || lines.back().line != line_no)
 	{
-		lines.emplace_back(uint16_t(line_no), 1);
+		lines.push_back({ uint32_t(line_no), uint32_t(code.size() + 1) });
 	}
 	else
 	{
-		lines.back().second++;
+		lines.back().end++;
 	}
 }
 
 int Code::get_line(int offset) const
 {
-	int count = 0;
+	// Find the first run that ends after the offset.
+	auto it = std::upper_bound(lines.begin(), lines.end(), offset, [](int offset, const LineRun &run) {
+		return offset < int(run.end);
+	});
 
-	for (auto ln : lines)
-	{
-		count += ln.second;
-
-		if (offset < count) {
-			return ln.first;
-		}
+	if (unlikely(offset < 0 || it == lines.end())) {
+		throw error("[Internal error] Cannot determine line number: invalid offset %", offset);
 	}
 
-	throw error("[Internal error] Cannot determine line number: invalid offset %", offset);
+	return int(it->line);
 }
 
 void Code::emit_return()
 {
-	intptr_t index = lines.empty() ? intptr_t(0) : intptr_t(lines.back().first);
+	intptr_t index = lines.empty() ? intptr_t(0) : intptr_t(lines.back().line);
 	emit(index, Opcode::Return);
 }
 
@@ -149,6 +144,22 @@ void Code::backpatch(int at, int value)
 	code[at + 1] = s.ins[1];
 }
 
+void Code::emit_constant(intptr_t line_no, Opcode op, uint32_t index)
+{
+	static_assert(sizeof(Instruction) == 2);
+
+	if (index > (std::numeric_limits<Instruction>::max)()) {
+		emit(line_no, Opcode::Wide, Instruction(index >> 16));
+	}
+	emit(line_no, op, Instruction(index & 0xffff));
+}
+
+void Code::emit_constant(intptr_t line_no, Opcode op, uint32_t index, Instruction i)
+{
+	emit_constant(line_no, op, index);
+	emit(line_no, i);
+}
+
 int Code::read_integer(const Instruction *&ip)
 {
 	IntSerializer s;
@@ -102,16 +102,28 @@ enum class Opcode : Instruction
 	SetUpvalue,
 	Subtract,
 	TestIterator,
-	Throw
+	Throw,
+	Wide				// Provide the high 16 bits of the next instruction's first operand
 };
 
+// Number of opcodes. Wide must remain the last opcode.
+static constexpr size_t OPCODE_COUNT = size_t(Opcode::Wide) + 1;
+
 
 class Code final
 {
 	using Storage = std::vector<Instruction>;
 
-	// For error reporting.
-	using LineNo = uint16_t;
+	// A sequence of consecutive instructions generated from the same line.
+	struct LineRun
+	{
+		// Line number in the source code.
+		uint32_t line;
+
+		// Offset one past the last instruction of the run. This is the running sum of the lengths of all the runs up to
+		// this one, which makes the table sorted by offset.
+		uint32_t end;
+	};
 
 public:
 
@@ -131,6 +143,8 @@ public:
 
 	~Code() = default;
 
+	Code &operator=(Code &&) = default;
+
 	void emit(intptr_t line_no, Instruction i) { add_line(line_no); code.push_back(i); }
 
 	void emit(intptr_t line_no, Opcode op) { emit(line_no, static_cast<Instruction>(op)); }
@@ -139,6 +153,12 @@ public:
 
 	void emit(intptr_t line_no, Opcode op, Instruction i1, Instruction i2) { emit(line_no, op); emit(line_no, i1); emit(line_no, i2); }
 
+	// Emit an instruction whose first operand is an index into a constant pool. If the index doesn't fit in an instruction,
+	// it is preceded by a Wide prefix which holds its high bits.
+	void emit_constant(intptr_t line_no, Opcode op, uint32_t index);
+
+	void emit_constant(intptr_t line_no, Opcode op, uint32_t index, Instruction i);
+
 	static int read_integer(const Instruction *&ip);
 
 	void emit_return();
@@ -174,9 +194,8 @@ private:
 	// Byte codes.
 	Storage code;
 
-	// Line numbers on which byte codes are found, for error reporting.
-	// first = line number; second = number of instructions on that line
-	std::vector<std::pair<LineNo,LineNo>> lines;
+	// Line numbers on which byte codes are found, for error reporting. Lookups use a binary search on the end offsets.
+	std::vector<LineRun> lines;
 };
 
 } // namespace phonometrica
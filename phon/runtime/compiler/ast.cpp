@@ -12,12 +12,41 @@
  *                                                                                                                    *
  **********************************************************************************************************************/
 
+#include <cassert>
+#include <cstddef>
 #include <phon/runtime/compiler/ast.hpp>
 
 #define VISIT(NODE) v.visit_##NODE(this);
 
 namespace phonometrica {
 
+AstArena::~AstArena()
+{
+	// Destroy nodes in reverse order of creation.
+	for (auto it = m_destructors.rbegin(); it != m_destructors.rend(); ++it) {
+		it->destroy(it->node);
+	}
+}
+
+void *AstArena::allocate(size_t size)
+{
+	constexpr size_t alignment = alignof(std::max_align_t);
+	size = (size + alignment - 1) & ~(alignment - 1);
+	assert(size <= BlockSize);
+
+	if (size_t(m_end - m_pos) < size)
+	{
+		m_blocks.push_back(std::make_unique<char[]>(BlockSize));
+		m_pos = m_blocks.back().get();
+		m_end = m_pos + BlockSize;
+	}
+	auto ptr = m_pos;
+	m_pos += size;
+	m_used += size;
+
+	return ptr;
+}
+
 void phonometrica::UnaryExpression::visit(AstVisitor &v)
 {
 	VISIT(unary);
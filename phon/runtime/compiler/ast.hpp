@@ -16,6 +16,8 @@
 #define PHONOMETRICA_AST_HPP
 
 #include <memory>
+#include <type_traits>
+#include <vector>
 #include <phon/string.hpp>
 #include <phon/runtime/compiler/token.hpp>
 
@@ -24,16 +26,52 @@ namespace phonometrica {
 // Forward declarations
 class AstVisitor;
 struct Ast;
-using AutoAst = std::unique_ptr<Ast>;
-
-// Abstract base class for all AST nodes
+using AstPtr = Ast*;
+
+// Concrete node types.
+enum class AstKind : uint8_t
+{
+	Assignment,
+	ConstantLiteral,
+	FloatLiteral,
+	IntegerLiteral,
+	StringLiteral,
+	ListLiteral,
+	ArrayLiteral,
+	TableLiteral,
+	SetLiteral,
+	ReferenceExpression,
+	UnaryExpression,
+	BinaryExpression,
+	ConcatExpression,
+	Variable,
+	StatementList,
+	Declaration,
+	PrintStatement,
+	DebugStatement,
+	ThrowStatement,
+	AssertStatement,
+	IfCondition,
+	IfStatement,
+	WhileStatement,
+	RepeatStatement,
+	ForStatement,
+	ForeachStatement,
+	LoopExitStatement,
+	RoutineParameter,
+	RoutineDefinition,
+	CallExpression,
+	IndexedExpression,
+	ReturnStatement,
+};
+
+// Abstract base class for all AST nodes. Nodes are allocated from an AstArena, which owns them: they must not be
+// deleted individually.
 struct Ast
 {
 	using Lexeme = Token::Lexeme;
 
-	explicit Ast(int ln) : line_no(ln) { }
-
-	virtual ~Ast() = default;
+	Ast(AstKind kind, int ln) : line_no(ln), kind(kind) { }
 
 	virtual void visit(AstVisitor &v) = 0;
 
@@ -42,16 +80,84 @@ struct Ast
 	virtual void mark_assigned() { is_assigned = true; }
 
 	template<class T>
-	bool is() const { return dynamic_cast<const T*>(this) != nullptr; }
+	bool is() const { return kind == T::static_kind; }
 
 	// Line number, for error reporting.
 	int line_no;
 
+	// Type of the node.
+	AstKind kind;
+
 	// Whether the node is the left hand side of an assignment
 	bool is_assigned = false;
+
+protected:
+
+	// Nodes are destroyed by their arena, which knows their concrete type.
+	~Ast() = default;
 };
 
-using AstList = std::vector<AutoAst>;
+// Downcast a node (which may be null) to a concrete type. Returns null if the node doesn't have this type.
+template<class T>
+T *ast_cast(Ast *node)
+{
+	return (node && node->is<T>()) ? static_cast<T*>(node) : nullptr;
+}
+
+using AstList = std::vector<AstPtr>;
+
+// Bump allocator for AST nodes. Nodes are carved out of large blocks and are all released at once when the arena is
+// destroyed. The arena also holds the root of the tree that was parsed into it.
+class AstArena final
+{
+public:
+
+	AstArena() = default;
+
+	AstArena(const AstArena &) = delete;
+
+	~AstArena();
+
+	template<class T, class... Args>
+	T *make(Args &&... args)
+	{
+		auto node = new (allocate(sizeof(T))) T(std::forward<Args>(args)...);
+
+		// Nodes which only hold scalars and pointers don't need to be destroyed.
+		if constexpr (!std::is_trivially_destructible_v<T>) {
+			m_destructors.push_back({ node, [](void *ptr) { static_cast<T*>(ptr)->~T(); } });
+		}
+
+		return node;
+	}
+
+	// Number of bytes used by the nodes.
+	size_t size() const { return m_used; }
+
+	AstPtr root = nullptr;
+
+private:
+
+	struct Destructor
+	{
+		void *node;
+		void (*destroy)(void *);
+	};
+
+	void *allocate(size_t size);
+
+	std::vector<std::unique_ptr<char[]>> m_blocks;
+
+	std::vector<Destructor> m_destructors;
+
+	char *m_pos = nullptr;
+
+	char *m_end = nullptr;
+
+	size_t m_used = 0;
+
+	static constexpr size_t BlockSize = 65536;
+};
 
 // Base class for data passed to AST visitors
 struct AstContext
@@ -65,20 +171,22 @@ struct AstContext
 
 struct Assignment final : public Ast
 {
-	Assignment(int line, AutoAst lhs, AutoAst rhs, Lexeme op = Lexeme::OpAssign) :
-		Ast(line), lhs(std::move(lhs)), rhs(std::move(rhs)), op(op) { }
+	static constexpr AstKind static_kind = AstKind::Assignment;
+
+	Assignment(int line, AstPtr lhs, AstPtr rhs, Lexeme op = Lexeme::OpAssign) :
+		Ast(AstKind::Assignment, line), lhs(std::move(lhs)), rhs(std::move(rhs)), op(op) { }
 
 	void visit(AstVisitor &v) override;
 
 	Lexeme get_operator() const;
 
-	AutoAst lhs, rhs;
+	AstPtr lhs, rhs;
 	Lexeme op;
 };
 
 struct Literal : public Ast
 {
-	explicit Literal(int line) : Ast(line) { }
+	Literal(AstKind kind, int line) : Ast(kind, line) { }
 
 	bool is_literal() const override { return true; }
 };
@@ -86,7 +194,9 @@ struct Literal : public Ast
 // null, nan, true, false
 struct ConstantLiteral final : public Literal
 {
-	ConstantLiteral(int line, Lexeme lex) : Literal(line), lex(lex) { }
+	static constexpr AstKind static_kind = AstKind::ConstantLiteral;
+
+	ConstantLiteral(int line, Lexeme lex) : Literal(AstKind::ConstantLiteral, line), lex(lex) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -95,7 +205,9 @@ struct ConstantLiteral final : public Literal
 
 struct FloatLiteral final : public Literal
 {
-	FloatLiteral(int line, double value) : Literal(line), value(value) { }
+	static constexpr AstKind static_kind = AstKind::FloatLiteral;
+
+	FloatLiteral(int line, double value) : Literal(AstKind::FloatLiteral, line), value(value) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -104,7 +216,9 @@ struct FloatLiteral final : public Literal
 
 struct IntegerLiteral final : public Literal
 {
-	IntegerLiteral(int line, intptr_t value) : Literal(line), value(value) { }
+	static constexpr AstKind static_kind = AstKind::IntegerLiteral;
+
+	IntegerLiteral(int line, intptr_t value) : Literal(AstKind::IntegerLiteral, line), value(value) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -113,7 +227,9 @@ struct IntegerLiteral final : public Literal
 
 struct StringLiteral final : public Literal
 {
-	StringLiteral(int line, String value) : Literal(line), value(std::move(value)) { }
+	static constexpr AstKind static_kind = AstKind::StringLiteral;
+
+	StringLiteral(int line, String value) : Literal(AstKind::StringLiteral, line), value(std::move(value)) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -122,7 +238,9 @@ struct StringLiteral final : public Literal
 
 struct ListLiteral final : public Literal
 {
-	ListLiteral(int line, AstList items) : Literal(line), items(std::move(items)){ }
+	static constexpr AstKind static_kind = AstKind::ListLiteral;
+
+	ListLiteral(int line, AstList items) : Literal(AstKind::ListLiteral, line), items(std::move(items)){ }
 
 	void visit(AstVisitor &v) override;
 
@@ -131,7 +249,9 @@ struct ListLiteral final : public Literal
 
 struct ArrayLiteral final : public Literal
 {
-	ArrayLiteral(int line, AstList items, intptr_t nrow, intptr_t ncol) : Literal(line),
+	static constexpr AstKind static_kind = AstKind::ArrayLiteral;
+
+	ArrayLiteral(int line, AstList items, intptr_t nrow, intptr_t ncol) : Literal(AstKind::ArrayLiteral, line),
 		items(std::move(items)), nrow(nrow), ncol(ncol) { }
 
 	void visit(AstVisitor &v) override;
@@ -143,7 +263,9 @@ struct ArrayLiteral final : public Literal
 // Table
 struct TableLiteral final : public Literal
 {
-	TableLiteral(int line, AstList keys, AstList values) : Literal(line), keys(std::move(keys)), values(std::move(values)) { }
+	static constexpr AstKind static_kind = AstKind::TableLiteral;
+
+	TableLiteral(int line, AstList keys, AstList values) : Literal(AstKind::TableLiteral, line), keys(std::move(keys)), values(std::move(values)) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -152,7 +274,9 @@ struct TableLiteral final : public Literal
 
 struct SetLiteral final : public Literal
 {
-	SetLiteral(int line, AstList values) : Literal(line), values(std::move(values)) { }
+	static constexpr AstKind static_kind = AstKind::SetLiteral;
+
+	SetLiteral(int line, AstList values) : Literal(AstKind::SetLiteral, line), values(std::move(values)) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -163,36 +287,44 @@ struct SetLiteral final : public Literal
 
 struct ReferenceExpression final : public Ast
 {
-	ReferenceExpression(int line, AutoAst e) : Ast(line), expr(std::move(e)) { }
+	static constexpr AstKind static_kind = AstKind::ReferenceExpression;
+
+	ReferenceExpression(int line, AstPtr e) : Ast(AstKind::ReferenceExpression, line), expr(std::move(e)) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst expr;
+	AstPtr expr;
 };
 
 struct UnaryExpression final : public Ast
 {
-	UnaryExpression(int line, Lexeme op, AutoAst expr) : Ast(line), op(op), expr(std::move(expr)) { }
+	static constexpr AstKind static_kind = AstKind::UnaryExpression;
+
+	UnaryExpression(int line, Lexeme op, AstPtr expr) : Ast(AstKind::UnaryExpression, line), op(op), expr(std::move(expr)) { }
 
 	void visit(AstVisitor &v) override;
 
 	Lexeme op;
-	AutoAst expr;
+	AstPtr expr;
 };
 
 struct BinaryExpression final : public Ast
 {
-	BinaryExpression(int line, Lexeme op, AutoAst lhs, AutoAst rhs) : Ast(line), op(op), lhs(std::move(lhs)), rhs(std::move(rhs)) { }
+	static constexpr AstKind static_kind = AstKind::BinaryExpression;
+
+	BinaryExpression(int line, Lexeme op, AstPtr lhs, AstPtr rhs) : Ast(AstKind::BinaryExpression, line), op(op), lhs(std::move(lhs)), rhs(std::move(rhs)) { }
 
 	void visit(AstVisitor &v) override;
 
 	Lexeme op;
-	AutoAst lhs, rhs;
+	AstPtr lhs, rhs;
 };
 
 struct ConcatExpression final : public Ast
 {
-	ConcatExpression(int line, AstList lst) : Ast(line), list(std::move(lst)) { }
+	static constexpr AstKind static_kind = AstKind::ConcatExpression;
+
+	ConcatExpression(int line, AstList lst) : Ast(AstKind::ConcatExpression, line), list(std::move(lst)) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -201,7 +333,9 @@ struct ConcatExpression final : public Ast
 
 struct Variable final : public Ast
 {
-	Variable(int line, String name) : Ast(line), name(std::move(name)) { }
+	static constexpr AstKind static_kind = AstKind::Variable;
+
+	Variable(int line, String name) : Ast(AstKind::Variable, line), name(std::move(name)) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -212,7 +346,9 @@ struct Variable final : public Ast
 
 struct StatementList final : public Ast
 {
-	StatementList(int line, AstList stmts, bool open_scope = false) : Ast(line), statements(std::move(stmts)), open_scope(open_scope) { }
+	static constexpr AstKind static_kind = AstKind::StatementList;
+
+	StatementList(int line, AstList stmts, bool open_scope = false) : Ast(AstKind::StatementList, line), statements(std::move(stmts)), open_scope(open_scope) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -222,7 +358,9 @@ struct StatementList final : public Ast
 
 struct Declaration final : public Ast
 {
-	Declaration(int line, AstList lhs, AstList rhs, bool local) : Ast(line), lhs(std::move(lhs)), rhs(std::move(rhs)), local(local) { }
+	static constexpr AstKind static_kind = AstKind::Declaration;
+
+	Declaration(int line, AstList lhs, AstList rhs, bool local) : Ast(AstKind::Declaration, line), lhs(std::move(lhs)), rhs(std::move(rhs)), local(local) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -232,7 +370,9 @@ struct Declaration final : public Ast
 
 struct PrintStatement final : public Ast
 {
-	PrintStatement(int line, AstList lst, bool new_line) : Ast(line), list(std::move(lst)), new_line(new_line) { }
+	static constexpr AstKind static_kind = AstKind::PrintStatement;
+
+	PrintStatement(int line, AstList lst, bool new_line) : Ast(AstKind::PrintStatement, line), list(std::move(lst)), new_line(new_line) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -242,96 +382,116 @@ struct PrintStatement final : public Ast
 
 struct DebugStatement final : public Ast
 {
-	DebugStatement(int line, AutoAst block) : Ast(line), block(std::move(block)) { }
+	static constexpr AstKind static_kind = AstKind::DebugStatement;
+
+	DebugStatement(int line, AstPtr block) : Ast(AstKind::DebugStatement, line), block(std::move(block)) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst block;
+	AstPtr block;
 };
 
 struct ThrowStatement final : public Ast
 {
-	ThrowStatement(int line, AutoAst e) : Ast(line), expr(std::move(e)) { }
+	static constexpr AstKind static_kind = AstKind::ThrowStatement;
+
+	ThrowStatement(int line, AstPtr e) : Ast(AstKind::ThrowStatement, line), expr(std::move(e)) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst expr;
+	AstPtr expr;
 };
 
 struct AssertStatement final : public Ast
 {
-	AssertStatement(int line, AutoAst e, AutoAst msg) : Ast(line), expr(std::move(e)), msg(std::move(msg)) { }
+	static constexpr AstKind static_kind = AstKind::AssertStatement;
+
+	AssertStatement(int line, AstPtr e, AstPtr msg) : Ast(AstKind::AssertStatement, line), expr(std::move(e)), msg(std::move(msg)) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst expr, msg;
+	AstPtr expr, msg;
 };
 
 struct IfCondition final : public Ast
 {
-	IfCondition(int line, AutoAst cond, AutoAst block) : Ast(line), cond(std::move(cond)), block(std::move(block)) { }
+	static constexpr AstKind static_kind = AstKind::IfCondition;
+
+	IfCondition(int line, AstPtr cond, AstPtr block) : Ast(AstKind::IfCondition, line), cond(std::move(cond)), block(std::move(block)) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst cond, block;
+	AstPtr cond, block;
 	int conditional_jump = -1;
 	int unconditional_jump = -1;
 };
 
 struct IfStatement final : public Ast
 {
-	IfStatement(int line, AstList ifs, AutoAst else_block) : Ast(line), if_conds(std::move(ifs)), else_block(std::move(else_block)) { }
+	static constexpr AstKind static_kind = AstKind::IfStatement;
+
+	IfStatement(int line, AstList ifs, AstPtr else_block) : Ast(AstKind::IfStatement, line), if_conds(std::move(ifs)), else_block(std::move(else_block)) { }
 
 	void visit(AstVisitor &v) override;
 
 	// The first entry in this list represents the obligatory "if" statement.
 	// Additional entries represent optional "elsif" statements.
 	AstList if_conds;
-	AutoAst else_block;
+	AstPtr else_block;
 };
 
 struct WhileStatement final : public Ast
 {
-	WhileStatement(int line, AutoAst e, AutoAst block) : Ast(line), cond(std::move(e)), body(std::move(block)) { }
+	static constexpr AstKind static_kind = AstKind::WhileStatement;
+
+	WhileStatement(int line, AstPtr e, AstPtr block) : Ast(AstKind::WhileStatement, line), cond(std::move(e)), body(std::move(block)) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst cond, body;
+	AstPtr cond, body;
 };
 
 struct RepeatStatement final : public Ast
 {
-	RepeatStatement(int line, AutoAst e, AutoAst block) : Ast(line), cond(std::move(e)), body(std::move(block)) { }
+	static constexpr AstKind static_kind = AstKind::RepeatStatement;
+
+	RepeatStatement(int line, AstPtr e, AstPtr block) : Ast(AstKind::RepeatStatement, line), cond(std::move(e)), body(std::move(block)) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst cond, body;
+	AstPtr cond, body;
 };
 
 struct ForStatement final : public Ast
 {
-	ForStatement(int line, AutoAst var, AutoAst e1, AutoAst e2, AutoAst e3, AutoAst block, bool down) :
-		Ast(line), var(std::move(var)), start(std::move(e1)), end(std::move(e2)), step(std::move(e3)), block(std::move(block)), down(down) { }
+	static constexpr AstKind static_kind = AstKind::ForStatement;
+
+	ForStatement(int line, AstPtr var, AstPtr e1, AstPtr e2, AstPtr e3, AstPtr block, bool down) :
+		Ast(AstKind::ForStatement, line), var(std::move(var)), start(std::move(e1)), end(std::move(e2)), step(std::move(e3)), block(std::move(block)), down(down) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst var, start, end, step, block;
+	AstPtr var, start, end, step, block;
 	bool down;
 };
 
 struct ForeachStatement final : public Ast
 {
-	ForeachStatement(int line, AutoAst k, AutoAst v, AutoAst coll, AutoAst block) : Ast(line),
+	static constexpr AstKind static_kind = AstKind::ForeachStatement;
+
+	ForeachStatement(int line, AstPtr k, AstPtr v, AstPtr coll, AstPtr block) : Ast(AstKind::ForeachStatement, line),
 		key(std::move(k)), value(std::move(v)), collection(std::move(coll)), block(std::move(block)) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst key, value, collection, block;
+	AstPtr key, value, collection, block;
 };
 
 struct LoopExitStatement final : public Ast
 {
-	LoopExitStatement(int line, Lexeme lex) : Ast(line), lex(lex) { }
+	static constexpr AstKind static_kind = AstKind::LoopExitStatement;
+
+	LoopExitStatement(int line, Lexeme lex) : Ast(AstKind::LoopExitStatement, line), lex(lex) { }
 
 	void visit(AstVisitor &v) override;
 
@@ -342,37 +502,43 @@ struct LoopExitStatement final : public Ast
 
 struct RoutineParameter final : public Ast
 {
-	RoutineParameter(int line, AutoAst var, AutoAst type, bool ref) :
-		Ast(line), variable(std::move(var)), type(std::move(type)), by_ref(ref) { }
+	static constexpr AstKind static_kind = AstKind::RoutineParameter;
+
+	RoutineParameter(int line, AstPtr var, AstPtr type, bool ref) :
+		Ast(AstKind::RoutineParameter, line), variable(std::move(var)), type(std::move(type)), by_ref(ref) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst variable, type;
+	AstPtr variable, type;
 	bool by_ref;             // passed by value or by reference?
 	bool add_names = false;  // flag for the compiler
 };
 
 struct RoutineDefinition final : public Ast
 {
-	RoutineDefinition(int line, AutoAst name, AstList params, AutoAst body, bool local, bool method) :
-		Ast(line), name(std::move(name)),  body(std::move(body)), params(std::move(params)), local(local), method(method) { }
+	static constexpr AstKind static_kind = AstKind::RoutineDefinition;
+
+	RoutineDefinition(int line, AstPtr name, AstList params, AstPtr body, bool local, bool method) :
+		Ast(AstKind::RoutineDefinition, line), name(std::move(name)),  body(std::move(body)), params(std::move(params)), local(local), method(method) { }
 
 	void visit(AstVisitor &v) override;
 
 	bool is_expression() const { return name == nullptr; }
 
-	AutoAst name, body;
+	AstPtr name, body;
 	AstList params;
 	bool local, method;
 };
 
 struct CallExpression final : public Ast
 {
-	CallExpression(int line, AutoAst e, AstList args) : Ast(line), expr(std::move(e)), args(std::move(args)) { }
+	static constexpr AstKind static_kind = AstKind::CallExpression;
+
+	CallExpression(int line, AstPtr e, AstList args) : Ast(AstKind::CallExpression, line), expr(std::move(e)), args(std::move(args)) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst expr;
+	AstPtr expr;
 	AstList args;
 	// Flags for the compiler.
 	bool return_reference = false;
@@ -381,23 +547,27 @@ struct CallExpression final : public Ast
 
 struct IndexedExpression final : public Ast
 {
-	IndexedExpression(int line, AutoAst e, AstList i) : Ast(line), expr(std::move(e)), indexes(std::move(i)) { }
+	static constexpr AstKind static_kind = AstKind::IndexedExpression;
+
+	IndexedExpression(int line, AstPtr e, AstList i) : Ast(AstKind::IndexedExpression, line), expr(std::move(e)), indexes(std::move(i)) { }
 
 	void visit(AstVisitor &v) override;
 
 	size_t size() const { return indexes.size(); }
 
-	AutoAst expr;
+	AstPtr expr;
 	AstList indexes;
 };
 
 struct ReturnStatement final : public Ast
 {
-	ReturnStatement(int line, AutoAst e) : Ast(line), expr(std::move(e)) { }
+	static constexpr AstKind static_kind = AstKind::ReturnStatement;
+
+	ReturnStatement(int line, AstPtr e) : Ast(AstKind::ReturnStatement, line), expr(std::move(e)) { }
 
 	void visit(AstVisitor &v) override;
 
-	AutoAst expr;
+	AstPtr expr;
 };
 
 //---------------------------------------------------------------------------------------------------------------------
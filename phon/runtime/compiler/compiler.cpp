@@ -20,6 +20,7 @@
 
 #define VISIT() PHON_UNUSED(node); throw error("Cannot compile %", __FUNCTION__);
 #define EMIT(...) code->emit(node->line_no, __VA_ARGS__)
+#define EMIT_CONSTANT(...) code->emit_constant(node->line_no, __VA_ARGS__)
 #define THROW(...) throw RuntimeError(node->line_no, __VA_ARGS__)
 
 namespace phonometrica {
@@ -32,8 +33,10 @@ Compiler::Compiler(Runtime *rt) : runtime(rt)
 
 }
 
-Handle<Closure> Compiler::compile(AutoAst ast)
+Handle<Closure> Compiler::compile(const std::shared_ptr<AstArena> &tree)
 {
+	auto ast = tree->root;
+	this->tree = tree;
 	initialize();
 	// dummy value to fill the slot occupied by the function. This slot is popped on return.
 	code->emit(ast->line_no, Opcode::PushNull);
@@ -45,14 +48,60 @@ Handle<Closure> Compiler::compile(AutoAst ast)
 	// Fix number of locals.
 	code->backpatch_instruction(offset, (Instruction)routine->local_count());
 	finalize();
+	this->tree.reset();
 
 	return make_handle<Closure>(runtime, std::move(this->routine));
 }
 
+void Compiler::compile_deferred(const std::shared_ptr<Routine> &r)
+{
+	assert(r->deferred());
+	auto outer_routine = std::move(routine);
+	auto outer_code = code;
+	auto outer_scope = current_scope;
+	auto outer_scope_id = scope_id;
+	auto outer_depth = scope_depth;
+
+	// Deferred routines are defined in the module scope, which has ID 1 and depth 1. The enclosing routine may have
+	// declared local variables since the routine was defined, so we detach it: names that are not local to the routine
+	// must resolve to globals, as they would have when the definition was compiled.
+	current_scope = scope_id = scope_depth = 1;
+	open_scope(); // closed by restore()
+	auto parent = r->parent;
+	r->parent = nullptr;
+	set_routine(r);
+
+	auto restore = [&]() {
+		r->parent = parent;
+		set_routine(std::move(outer_routine));
+		code = outer_code;
+		current_scope = outer_scope;
+		scope_id = outer_scope_id;
+		scope_depth = outer_depth;
+	};
+
+	try
+	{
+		compile_body(r->definition);
+	}
+	catch (...)
+	{
+		// Leave the routine in its initial state: the error will be raised again on the next call.
+		r->clear_body();
+		restore();
+		throw;
+	}
+
+	r->definition = nullptr;
+	r->tree.reset();
+	restore();
+}
+
 void Compiler::initialize()
 {
 	scope_id = 0;
 	current_scope = 0;
+	scope_depth = 0;
 	set_routine(std::make_shared<Routine>(routine.get(), String()));
 }
 
@@ -60,6 +109,7 @@ void Compiler::finalize()
 {
 	code->emit_return();
 	code = nullptr;
+	routine->drop_constant_index();
 }
 
 int Compiler::open_scope()
@@ -114,21 +164,21 @@ void Compiler::visit_integer(IntegerLiteral *node)
 	else
 	{
 		auto index = routine->add_integer_constant(value);
-		EMIT(Opcode::PushInteger, index);
+		EMIT_CONSTANT(Opcode::PushInteger, index);
 	}
 }
 
 void Compiler::visit_float(FloatLiteral *node)
 {
 	auto index = routine->add_float_constant(node->value);
-	EMIT(Opcode::PushFloat, index);
+	EMIT_CONSTANT(Opcode::PushFloat, index);
 }
 
 void Compiler::visit_string(StringLiteral *node)
 {
 	// Don't move the node's value here, because we might revisit the node in case of a self-assignment.
 	auto index = routine->add_string_constant(node->value);
-	EMIT(Opcode::PushString, index);
+	EMIT_CONSTANT(Opcode::PushString, index);
 }
 
 void Compiler::visit_unary(UnaryExpression *node)
@@ -140,7 +190,7 @@ void Compiler::visit_unary(UnaryExpression *node)
 	{
 		if (node->expr->is<FloatLiteral>())
 		{
-			auto e = static_cast<FloatLiteral*>(node->expr.get());
+			auto e = static_cast<FloatLiteral*>(node->expr);
 			std::feclearexcept(FE_ALL_EXCEPT);
 			e->value = -e->value;
 			if (fetestexcept(FE_OVERFLOW | FE_UNDERFLOW)) {
@@ -150,7 +200,7 @@ void Compiler::visit_unary(UnaryExpression *node)
 		}
 		else if (node->expr->is<IntegerLiteral>())
 		{
-			auto e = static_cast<IntegerLiteral*>(node->expr.get());
+			auto e = static_cast<IntegerLiteral*>(node->expr);
 			if (e->value == (std::numeric_limits<intptr_t>::max)()) {
 				throw RuntimeError(node->line_no, "[Math error] Invalid negative integer literal");
 			}
@@ -197,11 +247,11 @@ void Compiler::visit_binary(BinaryExpression *node)
 	if (node->op == Lexeme::Dot)
 	{
 		node->lhs->visit(*this);
-		auto var = dynamic_cast<Variable*>(node->rhs.get());
+		auto var = ast_cast<Variable>(node->rhs);
 		if (var)
 		{
 			auto name = routine->add_string_constant(var->name);
-			EMIT(Opcode::PushString, name);
+			EMIT_CONSTANT(Opcode::PushString, name);
 
 			if (visiting_assigned_lhs) {
 				return; // SetIndex will be added by the assignment once we visit the RHS.
@@ -289,7 +339,7 @@ void Compiler::visit_declaration(Declaration *node)
 	if (node->lhs.size() != 1 || node->rhs.size() > 1) {
 		THROW("Multiple declaration not implemented");
 	}
-	auto ident = dynamic_cast<Variable*>(node->lhs.front().get());
+	auto ident = ast_cast<Variable>(node->lhs.front());
 	if (!ident) {
 		THROW("[Syntax error] Expected a variable name in declaration");
 	}
@@ -325,7 +375,7 @@ void Compiler::visit_declaration(Declaration *node)
 			node->rhs.front()->visit(*this);
 		}
 		auto index = routine->add_string_constant(ident->name);
-		EMIT(Opcode::DefineGlobal, index);
+		EMIT_CONSTANT(Opcode::DefineGlobal, index);
 	}
 }
 
@@ -418,19 +468,19 @@ void Compiler::visit_variable(Variable *node)
 
 		if (parsing_argument())
 		{
-			EMIT(Opcode::GetGlobalArg, var, Instruction(this->visit_arg));
+			EMIT_CONSTANT(Opcode::GetGlobalArg, var, Instruction(this->visit_arg));
 		}
 		else if (visiting_reference || visiting_assigned_lhs)
 		{
 			if (visiting_indexed_lhs || visiting_assigned_lhs) {
-				EMIT(Opcode::GetUniqueGlobal, var);
+				EMIT_CONSTANT(Opcode::GetUniqueGlobal, var);
 			}
 			else {
-				EMIT(Opcode::GetGlobalRef, var);
+				EMIT_CONSTANT(Opcode::GetGlobalRef, var);
 			}
 		}
 		else {
-			EMIT(Opcode::GetGlobal, var);
+			EMIT_CONSTANT(Opcode::GetGlobal, var);
 		}
 	}
 }
@@ -441,7 +491,7 @@ void Compiler::visit_assignment(Assignment *node)
 	auto op = node->get_operator();
 
 	// For self-assignment, we write an expression such as "x += y" as "x = x + y".
-	if ((var = dynamic_cast<Variable*>(node->lhs.get())))
+	if ((var = ast_cast<Variable>(node->lhs)))
 	{
 		if (op == Lexeme::OpAssign)
 		{
@@ -493,14 +543,14 @@ void Compiler::visit_assignment(Assignment *node)
 		else
 		{
 			auto arg = routine->add_string_constant(var->name);
-			EMIT(Opcode::SetGlobal, arg);
+			EMIT_CONSTANT(Opcode::SetGlobal, arg);
 		}
 		return;
 	}
 
 	IndexedExpression *lhs; BinaryExpression *dot;
 
-	if ((lhs = dynamic_cast<IndexedExpression*>(node->lhs.get())))
+	if ((lhs = ast_cast<IndexedExpression>(node->lhs)))
 	{
 		visiting_assigned_lhs = true;
 		node->lhs->visit(*this);
@@ -545,7 +595,7 @@ void Compiler::visit_assignment(Assignment *node)
 
 		EMIT(Opcode::SetIndex, Instruction(lhs->size()));
 	}
-	else if ((dot = dynamic_cast<BinaryExpression*>(node->lhs.get())) && dot->op == Lexeme::Dot)
+	else if ((dot = ast_cast<BinaryExpression>(node->lhs)) && dot->op == Lexeme::Dot)
 	{
 		visiting_assigned_lhs = true;
 		node->lhs->visit(*this);
@@ -614,7 +664,7 @@ void Compiler::visit_if_statement(IfStatement *node)
 	*/
 	for (auto &stmt : node->if_conds)
 	{
-		auto if_cond = static_cast<IfCondition*>(stmt.get());
+		auto if_cond = static_cast<IfCondition*>(stmt);
 		if_cond->visit(*this);
 		if_cond->unconditional_jump = code->emit_jump(node->line_no, Opcode::Jump);
 		// Now we are at the beginning of the next branch, we can backpatch JumpFalse
@@ -629,7 +679,7 @@ void Compiler::visit_if_statement(IfStatement *node)
 	// We can now backpatch the jump in i07 with i10
 	for (auto &stmt : node->if_conds)
 	{
-		auto if_cond = static_cast<IfCondition*>(stmt.get());
+		auto if_cond = static_cast<IfCondition*>(stmt);
 		code->backpatch(if_cond->unconditional_jump);
 	}
 }
@@ -680,7 +730,7 @@ void Compiler::visit_for_statement(ForStatement *node)
 	break_count = continue_count = 0;
 
 	// Initialize loop variable
-	auto ident = dynamic_cast<Variable*>(node->var.get());
+	auto ident = ast_cast<Variable>(node->var);
 	node->start->visit(*this);
 	auto var_index = add_local(ident->name);
 	EMIT(Opcode::DefineLocal, var_index);
@@ -750,24 +800,24 @@ void Compiler::visit_foreach_statement(ForeachStatement *node)
 	auto key_index = (std::numeric_limits<Instruction>::max)();
 	if (node->key)
 	{
-		auto ident = dynamic_cast<Variable*>(node->key.get());
+		auto ident = ast_cast<Variable>(node->key);
 		key_index = add_local(ident->name);
 	}
 	Instruction val_index;
 	bool ref_val = false;
 	bool has_key = bool(node->key);
 	ReferenceExpression *re;
-	AutoAst val_expr;
-	if ((re = dynamic_cast<ReferenceExpression*>(node->value.get())))
+	AstPtr val_expr = nullptr;
+	if ((re = ast_cast<ReferenceExpression>(node->value)))
 	{
 		ref_val = true;
-		val_expr = std::move(re->expr);
+		val_expr = re->expr;
 	}
 	else
 	{
-		val_expr = std::move(node->value);
+		val_expr = node->value;
 	}
-	auto val_ident = dynamic_cast<Variable*>(val_expr.get());
+	auto val_ident = ast_cast<Variable>(val_expr);
 	val_index = add_local(val_ident->name);
 
 	auto iter_index = add_local(iter_name);
@@ -848,7 +898,7 @@ void Compiler::visit_parameter(RoutineParameter *node)
 {
 	if (node->add_names)
 	{
-		auto ident = static_cast<Variable*>(node->variable.get());
+		auto ident = static_cast<Variable*>(node->variable);
 		// From the function's point of view, the parameters are just the first locals.
 		add_local(ident->name);
 	}
@@ -863,7 +913,7 @@ void Compiler::visit_parameter(RoutineParameter *node)
 		{
 			// Parameters with no type are implicitly tagged as Object.
 			auto id = routine->add_string_constant(Class::get_name<Object>());
-			EMIT(Opcode::GetGlobal, id);
+			EMIT_CONSTANT(Opcode::GetGlobal, id);
 		}
 	}
 }
@@ -873,44 +923,42 @@ void Compiler::visit_routine(RoutineDefinition *node)
 	if (node->params.size() > PARAM_BITSET_SIZE) {
 		throw RuntimeError(node->line_no, "[Syntax error] Maximum number of parameters exceeded (limit is %)", PARAM_BITSET_SIZE);
 	}
-	auto ident = static_cast<Variable*>(node->name.get());
+	auto ident = static_cast<Variable*>(node->name);
 	String name = ident ? ident->name : String();
 	/////////////////////////auto func = create_function_symbol(node, name);
 
-	// Compile inner routine.
-	auto previous_scope = open_scope();
-	auto outer_routine = routine;
-	set_routine(std::make_shared<Routine>(routine.get(), name));
-	EMIT(Opcode::NewFrame, 0);
-	int frame_offset = code->get_current_offset() - 1;
-
+	auto inner_routine = std::make_shared<Routine>(routine.get(), name);
 	for (size_t i = 0; i < node->params.size(); i++)
 	{
-		auto &p = node->params[i];
-		// Compile names in the new function.
-		auto param = static_cast<RoutineParameter*>(p.get());
-		param->add_names = true;
-		if (param->by_ref) {
-			routine->ref_flags[i] = true;
+		if (static_cast<RoutineParameter*>(node->params[i])->by_ref) {
+			inner_routine->ref_flags[i] = true;
 		}
-		p->visit(*this);
 	}
-	node->body->visit(*this);
-	EMIT(Opcode::Return);
-	// Fix number of locals.
-	code->backpatch_instruction(frame_offset, (Instruction)routine->local_count());
-	close_scope(previous_scope);
 
-	auto routine_index = outer_routine->add_routine(routine);
-	set_routine(std::move(outer_routine));
+	if (can_defer(node))
+	{
+		inner_routine->definition = node;
+		inner_routine->tree = tree;
+	}
+	else
+	{
+		// Compile inner routine.
+		auto previous_scope = open_scope();
+		auto outer_routine = routine;
+		set_routine(inner_routine);
+		compile_body(node);
+		close_scope(previous_scope);
+		set_routine(std::move(outer_routine));
+	}
+	auto routine_index = routine->add_routine(std::move(inner_routine));
 
 	// Compile type information in the outer routine.
 	for (auto &param : node->params)
 	{
-		static_cast<RoutineParameter*>(param.get())->add_names = false;
+		static_cast<RoutineParameter*>(param)->add_names = false;
 		param->visit(*this);
 	}
-	EMIT(Opcode::NewClosure, routine_index, Instruction(node->params.size()));
+	EMIT_CONSTANT(Opcode::NewClosure, routine_index, Instruction(node->params.size()));
 	if (node->is_expression()) {
 		return;
 	}
@@ -925,8 +973,34 @@ void Compiler::visit_routine(RoutineDefinition *node)
 	{
 		auto index = routine->add_string_constant(name);
 		// Don't use DefineGlobal, since we might be adding an overload to an existing function.
-		EMIT(Opcode::SetGlobal, index);
+		EMIT_CONSTANT(Opcode::SetGlobal, index);
+	}
+}
+
+bool Compiler::can_defer(RoutineDefinition *node) const
+{
+	// A named function defined in the module scope, before any local variable, can't refer to a local variable of the
+	// enclosing routine: it has no upvalues, so we can wait until it is called to compile its body. Other routines are
+	// compiled with their enclosing routine.
+	return !node->is_expression() && !node->local && !routine->parent && scope_depth == 1 && routine->local_count() == 0;
+}
+
+void Compiler::compile_body(RoutineDefinition *node)
+{
+	EMIT(Opcode::NewFrame, 0);
+	int frame_offset = code->get_current_offset() - 1;
+
+	for (auto &p : node->params)
+	{
+		// Compile names in the new function.
+		static_cast<RoutineParameter*>(p)->add_names = true;
+		p->visit(*this);
 	}
+	node->body->visit(*this);
+	EMIT(Opcode::Return);
+	// Fix number of locals.
+	code->backpatch_instruction(frame_offset, (Instruction)routine->local_count());
+	routine->drop_constant_index();
 }
 
 Instruction Compiler::add_local(const String &name)
@@ -955,7 +1029,7 @@ void Compiler::visit_return_statement(ReturnStatement *node)
 
 void Compiler::visit_reference_expression(ReferenceExpression *node)
 {
-	auto call = dynamic_cast<CallExpression*>(node->expr.get());
+	auto call = ast_cast<CallExpression>(node->expr);
 	if (call)
 	{
 		call->return_reference = true;
@@ -1052,4 +1126,5 @@ void Compiler::visit_index(IndexedExpression *node)
 
 #undef VISIT
 #undef EMIT
+#undef EMIT_CONSTANT
 #undef THROW
\ No newline at end of file
@@ -29,7 +29,10 @@ public:
 
 	explicit Compiler(Runtime *rt);
 
-	Handle<Closure> compile(AutoAst ast);
+	Handle<Closure> compile(const std::shared_ptr<AstArena> &tree);
+
+	// Compile the body of a routine whose compilation was deferred until its first call.
+	void compile_deferred(const std::shared_ptr<Routine> &r);
 
 	void visit_constant(ConstantLiteral *node) override;
 	void visit_integer(IntegerLiteral *node) override;
@@ -85,6 +88,10 @@ private:
 
 	void set_routine(std::shared_ptr<Routine> r);
 
+	bool can_defer(RoutineDefinition *node) const;
+
+	void compile_body(RoutineDefinition *node);
+
 	bool parsing_argument() const { return visit_arg >= 0; }
 
 	// Pointer to the current runtime.
@@ -93,6 +100,9 @@ private:
 	// Code of the routine being compiled.
 	Code *code = nullptr;
 
+	// Syntax tree being compiled. Deferred routines keep it alive until they are compiled.
+	std::shared_ptr<AstArena> tree;
+
 	// For each block that may contain breaks, we set break_count to 0. Whenever a break is found,
 	// the counter is incremented and the address to be backpatched is pushed onto break_jumps. At
 	// the end of the block, we reset the counter and backpatch the required number of addresses.
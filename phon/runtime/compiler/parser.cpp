@@ -78,13 +78,13 @@ bool Parser::accept(Lexeme lex)
 	return false;
 }
 
-AutoAst Parser::parse_file(const String &path)
+std::shared_ptr<AstArena> Parser::parse_file(const String &path)
 {
 	scanner.load_file(path);
 	return parse();
 }
 
-AutoAst Parser::parse_string(const String &path)
+std::shared_ptr<AstArena> Parser::parse_string(const String &path)
 {
 	scanner.load_string(path);
 	return parse();
@@ -97,10 +97,10 @@ int Parser::get_line()
 
 void Parser::initialize()
 {
-
+	arena = std::make_shared<AstArena>();
 }
 
-AutoAst Parser::parse()
+std::shared_ptr<AstArena> Parser::parse()
 {
 	initialize();
 	accept();
@@ -121,10 +121,13 @@ AutoAst Parser::parse()
 		while (token.is_separator()) accept();
 	}
 	expect(Lexeme::Eot, "at end of file");
-	return std::make_unique<StatementList>(line, std::move(block));
+	arena->root = arena->make<StatementList>(line, std::move(block));
+
+	// Hand the tree over to the caller, so that it is freed as soon as it is no longer needed.
+	return std::move(arena);
 }
 
-AutoAst Parser::parse_statement()
+AstPtr Parser::parse_statement()
 {
 	trace_ast();
 
@@ -208,7 +211,7 @@ AutoAst Parser::parse_statement()
 	{
 		auto stmt = parse_expression_statement();
 		CallExpression *e;
-		if ((e = dynamic_cast<CallExpression*>(stmt.get())))
+		if ((e = ast_cast<CallExpression>(stmt)))
 		{
 			e->discard_result = true;
 		}
@@ -217,7 +220,7 @@ AutoAst Parser::parse_statement()
 	}
 }
 
-AutoAst Parser::parse_statements(bool open_scope)
+AstPtr Parser::parse_statements(bool open_scope)
 {
 	trace_ast();
 	AstList block;
@@ -231,10 +234,10 @@ AutoAst Parser::parse_statements(bool open_scope)
 	}
 	accept(Lexeme::End);
 
-	return std::make_unique<StatementList>(line, std::move(block), open_scope);
+	return arena->make<StatementList>(line, std::move(block), open_scope);
 }
 
-AutoAst Parser::parse_if_block()
+AstPtr Parser::parse_if_block()
 {
 	trace_ast();
 	AstList block;
@@ -248,10 +251,10 @@ AutoAst Parser::parse_if_block()
 	}
 	accept(Lexeme::End);
 
-	return std::make_unique<StatementList>(line, std::move(block), true);
+	return arena->make<StatementList>(line, std::move(block), true);
 }
 
-AutoAst Parser::parse_print_statement()
+AstPtr Parser::parse_print_statement()
 {
 	trace_ast();
 	AstList lst;
@@ -270,7 +273,7 @@ AutoAst Parser::parse_print_statement()
 	return make<PrintStatement>(std::move(lst), add_newline);
 }
 
-AutoAst Parser::parse_expression_statement()
+AstPtr Parser::parse_expression_statement()
 {
 	trace_ast();
 	auto e = parse_expression();
@@ -289,13 +292,13 @@ AutoAst Parser::parse_expression_statement()
 	return e;
 }
 
-AutoAst Parser::parse_expression()
+AstPtr Parser::parse_expression()
 {
 	trace_ast();
 	return parse_conditional_expression();
 }
 
-AutoAst Parser::parse_declaration(bool local)
+AstPtr Parser::parse_declaration(bool local)
 {
 	trace_ast();
 	// rhs may be empty if the variable(s) are declared but not assigned.
@@ -325,7 +328,7 @@ AutoAst Parser::parse_declaration(bool local)
 	return make<Declaration>(std::move(lhs), std::move(rhs), local);
 }
 
-AutoAst Parser::parse_identifier(const char *msg)
+AstPtr Parser::parse_identifier(const char *msg)
 {
 	trace_ast();
 	// This may not be an identifier, but we will throw if that's not the case...
@@ -336,7 +339,7 @@ AutoAst Parser::parse_identifier(const char *msg)
 	return make<Variable>(runtime->intern_string(ident));
 }
 
-AutoAst Parser::parse_or_expression()
+AstPtr Parser::parse_or_expression()
 {
 	trace_ast();
 	auto e = parse_and_expression();
@@ -350,7 +353,7 @@ AutoAst Parser::parse_or_expression()
 	return e;
 }
 
-AutoAst Parser::parse_and_expression()
+AstPtr Parser::parse_and_expression()
 {
 	trace_ast();
 	auto e = parse_not_expression();
@@ -364,7 +367,7 @@ AutoAst Parser::parse_and_expression()
 	return e;
 }
 
-AutoAst Parser::parse_not_expression()
+AstPtr Parser::parse_not_expression()
 {
 	trace_ast();
 	if (accept(Lexeme::Not))
@@ -375,7 +378,7 @@ AutoAst Parser::parse_not_expression()
 	return parse_comp_expression();
 }
 
-AutoAst Parser::parse_comp_expression()
+AstPtr Parser::parse_comp_expression()
 {
 	trace_ast();
 	auto e = parse_additive_expression();
@@ -391,7 +394,7 @@ AutoAst Parser::parse_comp_expression()
 	return e;
 }
 
-AutoAst Parser::parse_additive_expression()
+AstPtr Parser::parse_additive_expression()
 {
 	trace_ast();
 	auto e = parse_multiplicative_expression();
@@ -409,7 +412,7 @@ AutoAst Parser::parse_additive_expression()
 	return e;
 }
 
-AutoAst Parser::parse_multiplicative_expression()
+AstPtr Parser::parse_multiplicative_expression()
 {
 	trace_ast();
 	auto e = parse_signed_expression();
@@ -424,7 +427,7 @@ AutoAst Parser::parse_multiplicative_expression()
 	return e;
 }
 
-AutoAst Parser::parse_signed_expression()
+AstPtr Parser::parse_signed_expression()
 {
 	trace_ast();
 	if (accept(Lexeme::OpMinus))
@@ -433,7 +436,7 @@ AutoAst Parser::parse_signed_expression()
 	return parse_exponential_expression();
 }
 
-AutoAst Parser::parse_exponential_expression()
+AstPtr Parser::parse_exponential_expression()
 {
 	trace_ast();
 	auto e = parse_call_expression();
@@ -445,7 +448,7 @@ AutoAst Parser::parse_exponential_expression()
 	return e;
 }
 
-AutoAst Parser::parse_call_expression()
+AstPtr Parser::parse_call_expression()
 {
 	trace_ast();
 	auto e = parse_ref_expression();
@@ -477,7 +480,7 @@ AutoAst Parser::parse_call_expression()
 	return e;
 }
 
-AutoAst Parser::parse_ref_expression()
+AstPtr Parser::parse_ref_expression()
 {
 	trace_ast();
 	if (accept(Lexeme::Ref)) {
@@ -490,7 +493,7 @@ AutoAst Parser::parse_ref_expression()
 	return parse_primary_expression();
 }
 
-AutoAst Parser::parse_primary_expression()
+AstPtr Parser::parse_primary_expression()
 {
 	trace_ast();
 	if (check(Lexeme::Identifier))
@@ -592,12 +595,12 @@ AstList Parser::parse_parameters()
 	return params;
 }
 
-AutoAst Parser::parse_parameter()
+AstPtr Parser::parse_parameter()
 {
 	trace_ast();
 	bool by_ref = accept(Lexeme::Ref);
 	auto var = parse_identifier("in parameter list");
-	AutoAst type;
+	AstPtr type = nullptr;
 	if (accept(Lexeme::As)) {
 		type = parse_expression();
 	}
@@ -605,11 +608,11 @@ AutoAst Parser::parse_parameter()
 	return make<RoutineParameter>(std::move(var), std::move(type), by_ref);
 }
 
-AutoAst Parser::parse_assertion()
+AstPtr Parser::parse_assertion()
 {
 	trace_ast();
 	auto e = parse_expression();
-	AutoAst msg;
+	AstPtr msg = nullptr;
 
 	if (accept(Lexeme::Comma))
 	{
@@ -619,7 +622,7 @@ AutoAst Parser::parse_assertion()
 	return make<AssertStatement>(std::move(e), std::move(msg));
 }
 
-AutoAst Parser::parse_concat_expression(AutoAst e)
+AstPtr Parser::parse_concat_expression(AstPtr e)
 {
 	trace_ast();
 	AstList lst;
@@ -637,11 +640,11 @@ AutoAst Parser::parse_concat_expression(AutoAst e)
 	return make<ConcatExpression>(std::move(lst));
 }
 
-AutoAst Parser::parse_if_statement()
+AstPtr Parser::parse_if_statement()
 {
 	trace_ast();
 	AstList ifs;
-	AutoAst else_block;
+	AstPtr else_block = nullptr;
 	auto line = get_line();
 	auto e = parse_expression();
 	expect(Lexeme::Then, "in \"if\" statement");
@@ -659,10 +662,10 @@ AutoAst Parser::parse_if_statement()
 		else_block = parse_if_block();
 	}
 
-	return std::make_unique<IfStatement>(line, std::move(ifs), std::move(else_block));
+	return arena->make<IfStatement>(line, std::move(ifs), std::move(else_block));
 }
 
-AutoAst Parser::parse_while_statement()
+AstPtr Parser::parse_while_statement()
 {
 	trace_ast();
 	auto line = get_line();
@@ -670,11 +673,11 @@ AutoAst Parser::parse_while_statement()
 	expect(Lexeme::Do, "in while statement");
 	auto block = parse_statements(true);
 
-	return std::make_unique<WhileStatement>(line, std::move(e), std::move(block));
+	return arena->make<WhileStatement>(line, std::move(e), std::move(block));
 }
 
 
-AutoAst Parser::parse_repeat_statement()
+AstPtr Parser::parse_repeat_statement()
 {
 	trace_ast();
 	auto line = get_line();
@@ -686,18 +689,18 @@ AutoAst Parser::parse_repeat_statement()
 		while (token.is_separator()) accept();
 	}
 	// The compiler we create the scope so that the until condition is in the same scope as the block.
-	auto body = std::make_unique<StatementList>(line, std::move(block), false);
+	auto body = arena->make<StatementList>(line, std::move(block), false);
 	auto cond = parse_expression();
 
-	return std::make_unique<RepeatStatement>(line, std::move(cond), std::move(body));
+	return arena->make<RepeatStatement>(line, std::move(cond), std::move(body));
 }
 
-AutoAst Parser::parse_for_statement()
+AstPtr Parser::parse_for_statement()
 {
 	trace_ast();
 	constexpr const char *hint = "in for loop";
 	auto line = get_line();
-	AutoAst e1, e2, e3;
+	AstPtr e1 = nullptr, e2 = nullptr, e3 = nullptr;
 	bool down = false;
 	// var keyword is optional
 	accept(Lexeme::Var);
@@ -726,22 +729,22 @@ AutoAst Parser::parse_for_statement()
 	// Don't open a scope for the block: we will open it ourselves so that we can include the loop variable in it.
 	auto block = parse_statements(false);
 
-	return std::make_unique<ForStatement>(line, std::move(var), std::move(e1), std::move(e2), std::move(e3), std::move(block), down);
+	return arena->make<ForStatement>(line, std::move(var), std::move(e1), std::move(e2), std::move(e3), std::move(block), down);
 }
 
-AutoAst Parser::parse_foreach_statement()
+AstPtr Parser::parse_foreach_statement()
 {
 	trace_ast();
 	constexpr const char *hint = "in foreach loop";
 	auto line = get_line();
-	AutoAst key;
+	AstPtr key = nullptr;
 	if (accept(Lexeme::Ref)) {
 		key = make<ReferenceExpression>(parse_identifier(hint));
 	}
 	else {
 		key = parse_identifier(hint);
 	}
-	AutoAst val;
+	AstPtr val = nullptr;
 
 	if (accept(Lexeme::Comma))
 	{
@@ -756,23 +759,23 @@ AutoAst Parser::parse_foreach_statement()
 	{
 		std::swap(key, val);
 	}
-	if (dynamic_cast<ReferenceExpression*>(key.get())) {
+	if (ast_cast<ReferenceExpression>(key)) {
 		report_error("Key in \"foreach\" loop cannot be grabbed by reference");
 	}
 	expect(Lexeme::In, hint);
 	auto coll = parse_expression();
 	// We need a reference, which will be grabbed by the iterator.
-	if (!dynamic_cast<ReferenceExpression*>(coll.get())) {
+	if (!ast_cast<ReferenceExpression>(coll)) {
 		coll = make<ReferenceExpression>(std::move(coll));
 	}
 	expect(Lexeme::Do, hint);
 	// Don't open a scope for the block: we will open it ourselves so that we can include the loop variable in it.
 	auto block = parse_statements(false);
 
-	return std::make_unique<ForeachStatement>(line, std::move(key), std::move(val), std::move(coll), std::move(block));
+	return arena->make<ForeachStatement>(line, std::move(key), std::move(val), std::move(coll), std::move(block));
 }
 
-AutoAst Parser::parse_conditional_expression()
+AstPtr Parser::parse_conditional_expression()
 {
 	trace_ast();
 	auto e = parse_or_expression();
@@ -789,7 +792,7 @@ AutoAst Parser::parse_conditional_expression()
 	return e;
 }
 
-AutoAst Parser::parse_function_declaration(bool local)
+AstPtr Parser::parse_function_declaration(bool local)
 {
 	trace_ast();
 	int line = get_line();
@@ -800,11 +803,11 @@ AutoAst Parser::parse_function_declaration(bool local)
 	// Don't open a scope for the block: the function will do it so that we include the parameters in the scope.
 	auto body = parse_statements(false);
 
-	return std::make_unique<RoutineDefinition>(line, std::move(name), std::move(params), std::move(body), local, false);
+	return arena->make<RoutineDefinition>(line, std::move(name), std::move(params), std::move(body), local, false);
 }
 
 
-AutoAst Parser::parse_function_expression()
+AstPtr Parser::parse_function_expression()
 {
 	trace_ast();
 	int line = get_line();
@@ -814,13 +817,13 @@ AutoAst Parser::parse_function_expression()
 	// Don't open a scope for the block: the function will do it so that we include the parameters in the scope.
 	auto body = parse_statements(false);
 
-	return std::make_unique<RoutineDefinition>(line, nullptr, std::move(params), std::move(body), true, false);
+	return arena->make<RoutineDefinition>(line, nullptr, std::move(params), std::move(body), true, false);
 }
 
-AutoAst Parser::parse_return_statement()
+AstPtr Parser::parse_return_statement()
 {
 	trace_ast();
-	AutoAst e;
+	AstPtr e = nullptr;
 
 	if (!token.is_separator())
 	{
@@ -830,7 +833,7 @@ AutoAst Parser::parse_return_statement()
 	return make<ReturnStatement>(std::move(e));
 }
 
-AutoAst Parser::parse_member_expression()
+AstPtr Parser::parse_member_expression()
 {
 	trace_ast();
 	auto e = parse_ref_expression();
@@ -843,7 +846,7 @@ AutoAst Parser::parse_member_expression()
 	return e;
 }
 
-AutoAst Parser::parse_list_literal()
+AstPtr Parser::parse_list_literal()
 {
 	trace_ast();
 	auto line = get_line();
@@ -863,10 +866,10 @@ AutoAst Parser::parse_list_literal()
 	skip_empty_lines();
 	expect(Lexeme::RSquare, "at the end of list or array literal");
 
-	return std::make_unique<ListLiteral>(line, std::move(items));
+	return arena->make<ListLiteral>(line, std::move(items));
 }
 
-AutoAst Parser::parse_array_literal()
+AstPtr Parser::parse_array_literal()
 {
 	intptr_t prev_ncol = -1;
 	intptr_t ncol = 1;
@@ -904,10 +907,10 @@ AutoAst Parser::parse_array_literal()
 	}
 	expect(Lexeme::RSquare, "in array literal");
 
-	return std::make_unique<ArrayLiteral>(line, std::move(items), nrow, ncol);
+	return arena->make<ArrayLiteral>(line, std::move(items), nrow, ncol);
 }
 
-AutoAst Parser::parse_table_literal()
+AstPtr Parser::parse_table_literal()
 {
 	trace_ast();
 	constexpr const char *hint = "in table literal";
@@ -933,7 +936,7 @@ AutoAst Parser::parse_table_literal()
 		skip_empty_lines();
 		expect(Lexeme::RCurl, hint);
 
-		return std::make_unique<TableLiteral>(line, std::move(keys), std::move(values));
+		return arena->make<TableLiteral>(line, std::move(keys), std::move(values));
 	}
 	else
 	{
@@ -945,7 +948,7 @@ AutoAst Parser::parse_table_literal()
 		skip_empty_lines();
 		expect(Lexeme::RCurl, "in set literal");
 
-		return std::make_unique<SetLiteral>(line, std::move(keys));
+		return arena->make<SetLiteral>(line, std::move(keys));
 	}
 }
 
@@ -978,16 +981,16 @@ void Parser::parse_option()
 	runtime->set_debug_mode(value);
 }
 
-AutoAst Parser::parse_debug_statement()
+AstPtr Parser::parse_debug_statement()
 {
 	trace_ast();
 	auto line = get_line();
-	AutoAst body = accept(Lexeme::Eol) ? parse_statements(true) : parse_statement();
+	AstPtr body = accept(Lexeme::Eol) ? parse_statements(true) : parse_statement();
 
-	return std::make_unique<DebugStatement>(line, std::move(body));
+	return arena->make<DebugStatement>(line, std::move(body));
 }
 
-AutoAst Parser::parse_throw_statement()
+AstPtr Parser::parse_throw_statement()
 {
 	trace_ast();
 	return make<ThrowStatement>(parse_expression());
@@ -44,9 +44,10 @@ public:
 
 	explicit Parser(Runtime *rt);
 
-	AutoAst parse_file(const String &path);
+	// Parse a file or a string. The returned arena owns the nodes, and its root is the top-level node.
+	std::shared_ptr<AstArena> parse_file(const String &path);
 
-	AutoAst parse_string(const String &path);
+	std::shared_ptr<AstArena> parse_string(const String &path);
 
 private:
 
@@ -54,9 +55,9 @@ private:
 
 	// Make node with default debug info.
 	template <class T, class... Args>
-	std::unique_ptr<T> make(Args &&... args)
+	T *make(Args &&... args)
 	{
-		return std::make_unique<T>(get_line(), std::forward<Args>(args)...);
+		return arena->make<T>(get_line(), std::forward<Args>(args)...);
 	}
 
 	int get_line();
@@ -80,87 +81,87 @@ private:
 
 	void report_error(const std::string &hint, const char *error_type = "Syntax");
 
-	AutoAst parse();
+	std::shared_ptr<AstArena> parse();
 
 	void parse_option();
 
-	AutoAst parse_statement();
+	AstPtr parse_statement();
 
-	AutoAst parse_statements(bool open_scope);
+	AstPtr parse_statements(bool open_scope);
 
-	AutoAst parse_print_statement();
+	AstPtr parse_print_statement();
 
-	AutoAst parse_expression_statement();
+	AstPtr parse_expression_statement();
 
-	AutoAst parse_expression();
+	AstPtr parse_expression();
 
-	AutoAst parse_conditional_expression();
+	AstPtr parse_conditional_expression();
 
-	AutoAst parse_declaration(bool local);
+	AstPtr parse_declaration(bool local);
 
-	AutoAst parse_or_expression();
+	AstPtr parse_or_expression();
 
-	AutoAst parse_and_expression();
+	AstPtr parse_and_expression();
 
-	AutoAst parse_not_expression();
+	AstPtr parse_not_expression();
 
-	AutoAst parse_comp_expression();
+	AstPtr parse_comp_expression();
 
-	AutoAst parse_additive_expression(); // +, -, &
+	AstPtr parse_additive_expression(); // +, -, &
 
-	AutoAst parse_multiplicative_expression(); // *, /, %
+	AstPtr parse_multiplicative_expression(); // *, /, %
 
-	AutoAst parse_signed_expression(); // +x, -x
+	AstPtr parse_signed_expression(); // +x, -x
 
-	AutoAst parse_exponential_expression(); // ^
+	AstPtr parse_exponential_expression(); // ^
 
-	AutoAst parse_call_expression();
+	AstPtr parse_call_expression();
 
-	AutoAst parse_ref_expression();
+	AstPtr parse_ref_expression();
 
-	AutoAst parse_primary_expression();
+	AstPtr parse_primary_expression();
 
 	AstList parse_arguments();
 
 	AstList parse_parameters();
 
-	AutoAst parse_parameter();
+	AstPtr parse_parameter();
 
-	AutoAst parse_identifier(const char *msg);
+	AstPtr parse_identifier(const char *msg);
 
-	AutoAst parse_assertion();
+	AstPtr parse_assertion();
 
-	AutoAst parse_concat_expression(AutoAst e);
+	AstPtr parse_concat_expression(AstPtr e);
 
-	AutoAst parse_if_statement();
+	AstPtr parse_if_statement();
 
-	AutoAst parse_if_block();
+	AstPtr parse_if_block();
 
-	AutoAst parse_while_statement();
+	AstPtr parse_while_statement();
 
-	AutoAst parse_repeat_statement();
+	AstPtr parse_repeat_statement();
 
-	AutoAst parse_for_statement();
+	AstPtr parse_for_statement();
 
-	AutoAst parse_foreach_statement();
+	AstPtr parse_foreach_statement();
 
-	AutoAst parse_function_declaration(bool local);
+	AstPtr parse_function_declaration(bool local);
 
-	AutoAst parse_function_expression();
+	AstPtr parse_function_expression();
 
-	AutoAst parse_return_statement();
+	AstPtr parse_return_statement();
 
-	AutoAst parse_member_expression();
+	AstPtr parse_member_expression();
 
-	AutoAst parse_list_literal();
+	AstPtr parse_list_literal();
 
-	AutoAst parse_array_literal();
+	AstPtr parse_array_literal();
 
-	AutoAst parse_table_literal();
+	AstPtr parse_table_literal();
 
-	AutoAst parse_debug_statement();
+	AstPtr parse_debug_statement();
 
-	AutoAst parse_throw_statement();
+	AstPtr parse_throw_statement();
 
 
 
@@ -170,6 +171,9 @@ private:
 	// Current token.
 	Token token;
 
+	// Arena in which nodes are allocated while parsing.
+	std::shared_ptr<AstArena> arena;
+
 	// Pointer to the runtime, for string interning.
 	Runtime *runtime;
 };
@@ -12,8 +12,10 @@
  *                                                                                                                    *
  **********************************************************************************************************************/
 
+#include <cstring>
 #include <phon/file.hpp>
 #include <phon/runtime/compiler/scanner.hpp>
+#include <phon/third_party/sol/unicode.hpp>
 
 namespace phonometrica {
 
@@ -21,180 +23,191 @@ Scanner::Scanner() :
     m_source(std::make_shared<SourceCode>())
 {
     m_line_no = 0;
-    m_pos = nullptr;
     m_char = 0;
 }
 
 void Scanner::load_file(const String &path)
 {
-    reset();
     m_source->load_file(path);
+    reset();
     read_char();
 }
 
 void Scanner::load_string(const String &code)
 {
-    reset();
     m_source->load_code(code);
+    reset();
     read_char();
 }
 
 void Scanner::reset()
 {
-    m_pos = nullptr;
-    m_line_no = 0;
-    m_line.clear();
+    auto &text = m_source->text();
+    m_begin = text.data();
+    m_end = m_begin + text.size();
+    m_line_start = m_char_pos = m_pos = m_begin;
+    m_line_no = (m_begin == m_end) ? 0 : 1;
     m_char = 0;
 }
 
-void Scanner::rewind()
-{
-    if (m_char != Token::ETX)
-    {
-        // Move back to the beginning of the string
-        m_pos = m_line.begin();
-        read_char();
-    }
-    else
-    {
-        m_pos = nullptr;
-    }
-}
-
 void Scanner::read_char()
 {
     // Never read past the end of the source
     assert(m_char != Token::ETX);
 
-    if (m_pos == m_line.end() || m_pos == nullptr)
+    if (m_char == '\n' && m_pos != m_end)
+    {
+        m_line_no++;
+        m_line_start = m_pos;
+    }
+    m_char_pos = m_pos;
+
+    if (m_pos == m_end)
+    {
+        m_char = Token::ETX;
+    }
+    else if (static_cast<unsigned char>(*m_pos) < 0x80)
     {
-        read_line();
-        rewind();
+        m_char = static_cast<unsigned char>(*m_pos++);
     }
     else
     {
-        get_char();
+        decode_char();
     }
 }
 
-void Scanner::get_char()
-{
-    m_char = m_line.next_codepoint(m_pos);
-}
-
-void Scanner::set_line(intptr_t index)
+void Scanner::decode_char()
 {
-    m_line = m_source->get_line(index);
-}
+    auto result = sol::unicode::utf8_to_code_point(m_pos, m_end);
 
-void Scanner::read_line()
-{
-    if (m_line_no == m_source->size())
+    if (result.error != sol::unicode::error_code::ok)
     {
-        m_line.clear();
-        m_char = Token::ETX;
-    }
-    else
-    {
-        set_line(++m_line_no);
+        report_error(utils::format("invalid UTF-8 string: %", sol::unicode::to_string(result.error)), 0, "Unicode");
     }
+    m_pos = result.next;
+    m_char = result.codepoint;
 }
 
 void Scanner::skip_white()
 {
-
     while (check_space(m_char))
     {
         read_char();
     }
 }
 
-void Scanner::skip()
+String Scanner::scan_number(const char *start, bool &is_float)
 {
-    read_char();
-}
+    // Allow '_' as a group separator
+    bool has_separator = false;
+    auto scan_digits = [&]() {
+        while (is_digit(m_char) || m_char == '_')
+        {
+            has_separator |= (m_char == '_');
+            read_char();
+        }
+    };
 
-void Scanner::accept()
-{
-    m_spelling.append(m_char);
-    read_char();
-}
+    scan_digits();
+    is_float = (m_char == U'.');
 
-void Scanner::scan_digits()
-{
-    // Allow '_' as a group separator
-    while (isdigit(m_char) || m_char == '_')
+    if (is_float)
     {
-        if (m_char == '_')
-            skip();
-        else
-            accept();
+        read_char();
+        scan_digits();
     }
+
+    if (!has_separator) {
+        return spelling(start);
+    }
+
+    String result;
+    for (auto c = start; c < m_char_pos; c++)
+    {
+        if (*c != '_') result.push_back(*c);
+    }
+
+    return result;
 }
 
-void Scanner::scan_string(char32_t end)
+String Scanner::scan_string(char32_t end)
 {
     skip();
+    auto start = m_char_pos;
+    bool has_escape = false;
 
     while (m_char != end && m_char != Token::ETX)
     {
         if (m_char == '\\')
         {
-            // Skip for now. It may be restored if it's not a special character.
+            // Don't let an escaped delimiter terminate the string.
+            has_escape = true;
             skip();
-
-            if (m_char == 'n')
-            {
-                m_char = '\n'; // line feed (new line)
-            }
-            else if (m_char == 't')
-            {
-                m_char = '\t'; // horizontal tab
-            }
-            else if (m_char == 'r')
-            {
-                m_char = '\r'; // carriage return
-            }
-            else if (m_char == '\\')
-            {
-                m_char = '\\'; // backslash
-            }
-            else if (m_char == '\'')
-            {
-                m_char = '\''; // single quote
-            }
-            else if (m_char == '"')
-            {
-                m_char = '\"'; // double quote
-            }
-            else if (m_char == 'v')
-            {
-                m_char = '\v'; // vertical tab
-            }
-            else if (m_char == 'a')
-            {
-                m_char = '\a'; // audible bell
-            }
-            else if (m_char == 'b')
-            {
-                m_char = '\b'; // backspace
-            }
-            else if (m_char == 'f')
-            {
-                m_char = '\f'; // form feed (new page)
-            }
-            else
-            {
-                // Restore
-                m_spelling.push_back('\\');
-            }
+            if (m_char == Token::ETX) break;
         }
-        accept();
+        skip();
     }
 
+    auto stop = m_char_pos;
+
     // If we haven't reached the end of the text, ignore string terminating character
     if (m_char == end)
     { skip(); }
+
+    if (!has_escape) {
+        return String(start, intptr_t(stop - start));
+    }
+
+    String result(intptr_t(stop - start) + 1);
+
+    for (auto c = start; c < stop; c++)
+    {
+        if (*c != '\\' || c + 1 == stop)
+        {
+            result.push_back(*c);
+            continue;
+        }
+
+        switch (*++c)
+        {
+            case 'n':
+                result.push_back('\n'); // line feed (new line)
+                break;
+            case 't':
+                result.push_back('\t'); // horizontal tab
+                break;
+            case 'r':
+                result.push_back('\r'); // carriage return
+                break;
+            case '\\':
+                result.push_back('\\'); // backslash
+                break;
+            case '\'':
+                result.push_back('\''); // single quote
+                break;
+            case '"':
+                result.push_back('"'); // double quote
+                break;
+            case 'v':
+                result.push_back('\v'); // vertical tab
+                break;
+            case 'a':
+                result.push_back('\a'); // audible bell
+                break;
+            case 'b':
+                result.push_back('\b'); // backspace
+                break;
+            case 'f':
+                result.push_back('\f'); // form feed (new page)
+                break;
+            default:
+                // Restore
+                result.push_back('\\');
+                result.push_back(*c);
+        }
+    }
+
+    return result;
 }
 
 
@@ -202,18 +215,18 @@ void Scanner::scan_string(char32_t end)
 Token Scanner::read_token()
 {
     RETRY:
-    m_spelling.clear();
     skip_white();
+    auto start = m_char_pos;
 
     // An identifier must start with a Unicode "alphabetic character". This includes characters such as
     // Chinese '漢' or Korean '한'.
-    if (String::is_letter(m_char))
+    if (is_letter(m_char))
     {
-        accept();
+        skip();
 
-        while (String::is_letter(m_char) || isdigit(m_char) || m_char == U'_')
+        while (is_letter(m_char) || is_digit(m_char) || m_char == U'_')
         {
-            accept();
+            skip();
         }
 
         // Variable can end with '$'. This is used for "special" symbols, normally used for implementation details.
@@ -221,62 +234,56 @@ Token Scanner::read_token()
         // end with '$', although this is not enforced.
         if (m_char == U'$')
         {
-            accept();
+            skip();
             // Allow '$'*, so that users can for instance create their own `init$$` symbol if they want to.
             while (m_char == U'$')
-            { accept(); }
+            { skip(); }
         }
 
-        return Token(m_spelling, m_line_no, true);
+        return Token(spelling(start), m_line_no, true);
     }
 
     // Scan a number.
-    if (isdigit(m_char))
+    if (is_digit(m_char))
     {
-        accept();
-        scan_digits();
-
-        if (m_char == U'.')
-        {
-            accept();
-            scan_digits();
-			return Token(Token::Lexeme::FloatLiteral, m_spelling, m_line_no);
-        }
+        bool is_float;
+        auto number = scan_number(start, is_float);
+        auto lex = is_float ? Token::Lexeme::FloatLiteral : Token::Lexeme::IntegerLiteral;
 
-        return Token(Token::Lexeme::IntegerLiteral, m_spelling, m_line_no);
+        return Token(lex, number, m_line_no);
     }
 
     switch (m_char)
     {
     case U'=':
     {
-        accept();
+        skip();
 
         if (m_char == U'=')
         {
-            accept();
-            return Token(m_spelling, m_line_no, false);
+            skip();
+            return Token(Token::Lexeme::OpEqual, m_line_no);
         }
         else
         {
-            return Token(m_spelling, m_line_no, false);
+            return Token(Token::Lexeme::OpAssign, m_line_no);
         }
     }
     case U'\n':
 	{
-		accept();
-		// We return the previous line because after accept() we are already pointing to the beginning of the following line.
+		skip();
+		// We return the previous line because after skip() we are already pointing to the beginning of the following line.
 		return Token(Token::Lexeme::Eol, String(), m_line_no - 1);
 	}
     case U'"':
     {
-        scan_string(U'"');
-        return Token(Token::Lexeme::StringLiteral, m_spelling, m_line_no);
+        auto text = scan_string(U'"');
+        return Token(Token::Lexeme::StringLiteral, text, m_line_no);
     }
     case U'\'':
 	{
-		scan_string(U'\'');
-		return Token(Token::Lexeme::StringLiteral, m_spelling, m_line_no);
+		auto text = scan_string(U'\'');
+		return Token(Token::Lexeme::StringLiteral, text, m_line_no);
 	}
     case Token::ETX:
     {
@@ -285,123 +292,123 @@ Token Scanner::read_token()
     }
     case U'(':
     {
-	    accept();
-    	return Token(Token::Lexeme::LParen, "(", m_line_no);
+	    skip();
+    	return Token(Token::Lexeme::LParen, m_line_no);
     }
     case U')':
     {
-	    accept();
-	    return Token(Token::Lexeme::RParen, ")", m_line_no);
+	    skip();
+	    return Token(Token::Lexeme::RParen, m_line_no);
     }
     case U'{':
     {
-	    accept();
-	    return Token(Token::Lexeme::LCurl, "{", m_line_no);
+	    skip();
+	    return Token(Token::Lexeme::LCurl, m_line_no);
     }
     case U'}':
     {
-	    accept();
-	    return Token(Token::Lexeme::RCurl, "}", m_line_no);
+	    skip();
+	    return Token(Token::Lexeme::RCurl, m_line_no);
     }
     case U'[':
     {
-	    accept();
-	    return Token(Token::Lexeme::LSquare, "[", m_line_no);
+	    skip();
+	    return Token(Token::Lexeme::LSquare, m_line_no);
     }
     case U']':
     {
-	    accept();
-	    return Token(Token::Lexeme::RSquare, "]", m_line_no);
+	    skip();
+	    return Token(Token::Lexeme::RSquare, m_line_no);
     }
     case U'+':
     {
-    	accept();
+    	skip();
     	if (m_char == U'=')
     	{
-    		accept();
-    		return Token(Token::Lexeme::OpAssignPlus, "+=", m_line_no);
+    		skip();
+    		return Token(Token::Lexeme::OpAssignPlus, m_line_no);
     	}
-    	return Token(Token::Lexeme::OpPlus, "+", m_line_no);
+    	return Token(Token::Lexeme::OpPlus, m_line_no);
     }
     case U'-':
     {
-	    accept();
+	    skip();
 		if (m_char == U'=')
 		{
-			accept();
-			return Token(Token::Lexeme::OpAssignMinus, "-=", m_line_no);
+			skip();
+			return Token(Token::Lexeme::OpAssignMinus, m_line_no);
 		}
-	    return Token(Token::Lexeme::OpMinus, "-", m_line_no);
+	    return Token(Token::Lexeme::OpMinus, m_line_no);
     }
     case U'*':
     {
-	    accept();
+	    skip();
 		if (m_char == U'=')
 		{
-			accept();
-			return Token(Token::Lexeme::OpAssignStar, "*=", m_line_no);
+			skip();
+			return Token(Token::Lexeme::OpAssignStar, m_line_no);
 		}
-	    return Token(Token::Lexeme::OpStar, "*", m_line_no);
+	    return Token(Token::Lexeme::OpStar, m_line_no);
     }
     case U'/':
     {
-	    accept();
+	    skip();
 		if (m_char == U'=')
 		{
-			accept();
-			return Token(Token::Lexeme::OpAssignSlash, "/=", m_line_no);
+			skip();
+			return Token(Token::Lexeme::OpAssignSlash, m_line_no);
 		}
-	    return Token(Token::Lexeme::OpSlash, "/", m_line_no);
+	    return Token(Token::Lexeme::OpSlash, m_line_no);
     }
     case U'^':
 	{
-		accept();
+		skip();
 		if (m_char == U'=')
 		{
-			accept();
-			return Token(Token::Lexeme::OpAssignPower, "^=", m_line_no);
+			skip();
+			return Token(Token::Lexeme::OpAssignPower, m_line_no);
 		}
-		return Token(Token::Lexeme::OpPower, "^", m_line_no);
+		return Token(Token::Lexeme::OpPower, m_line_no);
 	}
    	case U'%':
 	{
-		accept();
+		skip();
 		if (m_char == U'=')
 		{
-			accept();
-			return Token(Token::Lexeme::OpAssignMod, "%=", m_line_no);
+			skip();
+			return Token(Token::Lexeme::OpAssignMod, m_line_no);
 		}
-		return Token(Token::Lexeme::OpMod, "%", m_line_no);
+		return Token(Token::Lexeme::OpMod, m_line_no);
 	}
     case U'&':
     {
-	    accept();
+	    skip();
 		if (m_char == U'=')
 		{
-			accept();
-			return Token(Token::Lexeme::OpAssignConcat, "&=", m_line_no);
+			skip();
+			return Token(Token::Lexeme::OpAssignConcat, m_line_no);
 		}
-	    return Token(Token::Lexeme::OpConcat, "&", m_line_no);
+	    return Token(Token::Lexeme::OpConcat, m_line_no);
     }
     case U',':
     {
-	    accept();
-	    return Token(Token::Lexeme::Comma, ",", m_line_no);
+	    skip();
+	    return Token(Token::Lexeme::Comma, m_line_no);
     }
     case U';':
     {
-	    accept();
-	    return Token(Token::Lexeme::Semicolon, ";", m_line_no);
+	    skip();
+	    return Token(Token::Lexeme::Semicolon, m_line_no);
     }
     case U':':
     {
-	    accept();
-	    return Token(Token::Lexeme::Colon, ":", m_line_no);
+	    skip();
+	    return Token(Token::Lexeme::Colon, m_line_no);
     }
     case U'.':
     {
-        accept();
-        return Token(Token::Lexeme::Dot, ".", m_line_no);
+        skip();
+        return Token(Token::Lexeme::Dot, m_line_no);
     }
     case U'#':
     {
@@ -412,12 +419,12 @@ Token Scanner::read_token()
     }
     case U'!':
     {
-        accept();
+        skip();
 
         if (m_char == U'=')
         {
-            accept();
-            return Token(Token::Lexeme::OpNotEqual, m_spelling, m_line_no);
+            skip();
+            return Token(Token::Lexeme::OpNotEqual, m_line_no);
         }
 
         report_error("invalid token");
@@ -425,45 +432,45 @@ Token Scanner::read_token()
     }
     case U'<':
     {
-        accept();
+        skip();
 
         if (m_char == U'=')
         {
-            accept();
+            skip();
 
             if (m_char == U'>')
             {
-                accept();
-                return Token(Token::Lexeme::OpCompare, m_spelling, m_line_no);
+                skip();
+                return Token(Token::Lexeme::OpCompare, m_line_no);
             }
             else
             {
-                return Token(Token::Lexeme::OpLessEqual, m_spelling, m_line_no);
+                return Token(Token::Lexeme::OpLessEqual, m_line_no);
             }
         }
         else
         {
-            return Token(Token::Lexeme::OpLessThan, m_spelling, m_line_no);
+            return Token(Token::Lexeme::OpLessThan, m_line_no);
         }
     }
     case U'>':
     {
-        accept();
+        skip();
 
         if (m_char == U'=')
         {
-            accept();
-            return Token(Token::Lexeme::OpGreaterEqual, m_spelling, m_line_no);
+            skip();
+            return Token(Token::Lexeme::OpGreaterEqual, m_line_no);
         }
         else
         {
-            return Token(Token::Lexeme::OpGreaterThan, m_spelling, m_line_no);
+            return Token(Token::Lexeme::OpGreaterThan, m_line_no);
         }
     }
 	case U'@':
 	{
-		accept();
-		return Token(Token::Lexeme::OpAt, m_spelling, m_line_no);
+		skip();
+		return Token(Token::Lexeme::OpAt, m_line_no);
 	}
 
     default:
@@ -478,10 +485,10 @@ Token Scanner::read_token()
 void Scanner::report_error(const std::string &hint, intptr_t offset, const char *error_type)
 {
 	assert(m_line_no != 0);
-	String line = m_source->get_line(m_line_no);
-	// These must be computed before trimming, since the iterator will be invalidated
-	auto step_back = intptr_t(m_pos > line.begin());
-	auto left_space = intptr_t(m_pos - line.begin());
+	auto eol = reinterpret_cast<const char*>(memchr(m_line_start, '\n', size_t(m_end - m_line_start)));
+	String line(m_line_start, intptr_t((eol ? eol : m_end) - m_line_start));
+	auto step_back = intptr_t(m_pos > m_line_start);
+	auto left_space = intptr_t(m_pos - m_line_start);
 
 	line.rtrim();
 
@@ -9,13 +9,15 @@
  * Created: 18/07/2019                                                                                                *
  *                                                                                                                    *
  * Purpose: the scanner performs lexical analysis of a chunk of source code, read from a file or from a string. The   *
- * source is expected (and assumed) to be encoded in UTF-8, and is scanned one code point at a time.                  *
+ * source is expected (and assumed) to be encoded in UTF-8. It is scanned directly from its buffer, and token         *
+ * spellings are only materialized as strings once a token is complete.                                               *
  *                                                                                                                    *
  **********************************************************************************************************************/
 
 #ifndef PHONOMETRICA_SCANNER_HPP
 #define PHONOMETRICA_SCANNER_HPP
 
+#include <memory>
 #include <phon/runtime/compiler/token.hpp>
 #include <phon/runtime/compiler/source_code.hpp>
 
@@ -49,42 +51,48 @@ private:
 	// Source code (from a file or string).
     std::shared_ptr<SourceCode> m_source;
 
-    // Current word (accumulates code points)
-    String m_spelling;
+    // Bounds of the source buffer.
+    const char *m_begin = nullptr;
+    const char *m_end = nullptr;
 
-    // Current line
-    String m_line;
+    // Beginning of the current line in the buffer.
+    const char *m_line_start = nullptr;
+
+    // Position of the current code point in the buffer, and position of the next one.
+    const char *m_char_pos = nullptr;
+    const char *m_pos = nullptr;
 
     // Current line number
     intptr_t m_line_no;
 
-    // Current position in the current line
-    String::const_iterator m_pos;
-
     // Current code point
     char32_t m_char;
 
     void reset();
 
-    void rewind();
-
     void read_char();
 
-    void get_char();
+    void decode_char();
 
-    void set_line(intptr_t index);
+    void skip_white();
 
-    void read_line();
+    void skip() { read_char(); }
 
-    void skip();
+    // Get the text from `start` up to (but excluding) the current code point.
+    String spelling(const char *start) const { return String(start, intptr_t(m_char_pos - start)); }
 
-    void skip_white();
+    String scan_number(const char *start, bool &is_float);
 
-    void accept();
+    String scan_string(char32_t end);
 
-    void scan_digits();
+    static bool is_digit(char32_t c) { return c >= '0' && c <= '9'; }
 
-    void scan_string(char32_t end);
+    // Same as String::is_letter(), with a shortcut for ASCII.
+    static bool is_letter(char32_t c)
+    {
+        if (c < 0x80) return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+        return String::is_letter(c);
+    }
 
 	// Same as isspace(), but does not consider '\n' as a space since it's used by the parser.
 	static bool check_space(char32_t c);
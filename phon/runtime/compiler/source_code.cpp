@@ -12,6 +12,7 @@
  *                                                                                                                    *
  **********************************************************************************************************************/
 
+#include <cstring>
 #include <phon/file.hpp>
 #include <phon/runtime/compiler/source_code.hpp>
 
@@ -24,23 +25,38 @@ SourceCode::SourceCode()
 
 void SourceCode::load_file(const String &path)
 {
-    File infile(path, File::Mode::Read);
-    m_lines = infile.read_lines();
+    m_text = File::read_all(path);
+    m_line_offsets.clear();
     this->m_path = path;
 }
 
 void SourceCode::load_code(const String &code)
 {
-    m_lines = code.split("\n");
-    // The splitter is stripped when splitting a string, so we need to put it back.
-    for (auto &ln : m_lines)
-    {
-        ln.append('\n');
+    m_text = code;
+    if (!m_text.ends_with("\n")) {
+        m_text.append('\n');
     }
-
+    m_line_offsets.clear();
     m_path.clear();
 }
 
+void SourceCode::index_lines() const
+{
+    if (!m_line_offsets.empty() || m_text.empty()) {
+        return;
+    }
+    auto begin = m_text.data();
+    auto end = begin + m_text.size();
+    auto pos = begin;
+
+    while (pos < end)
+    {
+        m_line_offsets.push_back(pos - begin);
+        auto eol = reinterpret_cast<const char*>(memchr(pos, '\n', size_t(end - pos)));
+        pos = eol ? eol + 1 : end;
+    }
+}
+
 String SourceCode::filename() const
 {
     return m_path.empty() ? String("string buffer") : m_path;
@@ -48,18 +64,24 @@ String SourceCode::filename() const
 
 String SourceCode::get_line(intptr_t index) const
 {
-    return m_lines[index];
+    index_lines();
+    assert(index > 0 && index <= intptr_t(m_line_offsets.size()));
+    auto from = m_line_offsets[size_t(index - 1)];
+    auto to = (size_t(index) < m_line_offsets.size()) ? m_line_offsets[size_t(index)] : m_text.size();
+
+    return String(m_text.data() + from, to - from);
 }
 
 intptr_t SourceCode::size() const
 {
-    return m_lines.size();
+    index_lines();
+    return intptr_t(m_line_offsets.size());
 }
 
 void SourceCode::report_error(const char *error_type, intptr_t line_no, const std::string &hint)
 {
     assert(line_no > 0);
-    String line = m_lines[line_no];
+    String line = get_line(line_no);
     line.rtrim();
     auto message = utils::format("[%] File \"%\" at line %\n\t%", error_type, this->filename(), line_no, line);
 
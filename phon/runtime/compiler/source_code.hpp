@@ -15,6 +15,7 @@
 #ifndef PHONOMETRICA_SOURCE_CODE_HPP
 #define PHONOMETRICA_SOURCE_CODE_HPP
 
+#include <vector>
 #include <phon/string.hpp>
 
 namespace phonometrica {
@@ -29,7 +30,7 @@ public:
 
     void dispose() { delete this; }
 
-    bool empty() const { return m_lines.empty(); }
+    bool empty() const { return m_text.empty(); }
 
     const String &path() const { return m_path; }
 
@@ -39,10 +40,15 @@ public:
     // Set source code from a string
     void load_code(const String &code);
 
+    // Get a line (1-based), including its end-of-line character.
     String get_line(intptr_t index) const;
 
+    // Number of lines in the source.
     intptr_t size() const;
 
+    // The whole source, as one contiguous buffer.
+    const String &text() const { return m_text; }
+
     // This is used by AST visitors. It is less detailed than an error reported by the scanner
     // since we can't use the token's position, but it's better than nothing...
     void report_error(const char *error_type, intptr_t line_no,  const std::string &hint = std::string());
@@ -52,8 +58,13 @@ private:
     // Current file (empty if memory buffer)
     String m_path;
 
-    // Current file
-    Array<String> m_lines;
+    // Content of the source. Code loaded from a string always ends with a new line.
+    String m_text;
+
+    // Byte offset of the beginning of each line. This is only needed to report errors and is built on demand.
+    mutable std::vector<intptr_t> m_line_offsets;
+
+    void index_lines() const;
 
 };
 
@@ -129,6 +129,12 @@ Token::Token(Lexeme type, const String &spelling, intptr_t line) :
 
 }
 
+Token::Token(Lexeme type, intptr_t line) :
+        spelling(token_names[static_cast<int>(type) + 1]), line_no(line), id(type)
+{
+
+}
+
 String Token::to_string() const
 {
     if (id == Lexeme::StringLiteral)
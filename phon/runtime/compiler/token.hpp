@@ -126,6 +126,9 @@ struct Token final
 
 	Token(Lexeme type, const String &spelling, intptr_t line);
 
+	// Token with a fixed spelling (operators and punctuation).
+	Token(Lexeme type, intptr_t line);
+
 	~Token() = default;
 
 	Token &operator=(const Token &) = default;
@@ -13,6 +13,7 @@
  **********************************************************************************************************************/
 
 #include <cstdarg>
+#include <cstring>
 #include <phon/file.hpp>
 #include <phon/error.hpp>
 #include <phon/utils/helpers.hpp>
@@ -29,7 +30,7 @@ static const unsigned char BOM_UTF32_BE[] = {0x00, 0x00, 0xfe, 0xff}; // UTF-32,
 
 
 File::File(const String &path, File::Mode mode, Encoding enc) :
-		m_path(path), m_mode(mode), m_owned(true)
+		m_path(path), m_mode(mode), m_owned(true), m_out_capacity(BufferSize)
 {
 	if (path.empty()) {
 		throw error("Cannot create file with an empty path");
@@ -99,6 +100,7 @@ File::File(const String &path, const String &mode, const String &encoding) :
 intptr_t File::size()
 {
     check_handle();
+	flush_output();
 	auto current_pos = ftell(m_handle);
 	fseek(m_handle, 0, SEEK_END);
 	auto end_pos = ftell(m_handle);
@@ -201,23 +203,43 @@ File::~File()
 
 File::File(File &&other) noexcept
 {
+	m_path = std::move(other.m_path);
 	m_handle = other.handle();
 	m_mode = other.m_mode;
 	m_enc = other.m_enc;
 	m_owned = other.m_owned;
+	m_buffer = std::move(other.m_buffer);
+	m_buffer_pos = other.m_buffer_pos;
+	m_buffer_end = other.m_buffer_end;
+	m_out = std::move(other.m_out);
+	m_out_pos = other.m_out_pos;
+	m_out_end = other.m_out_end;
+	m_out_capacity = other.m_out_capacity;
 
 	other.m_handle = nullptr;
+	other.m_buffer_pos = other.m_buffer_end = nullptr;
+	other.m_out_pos = other.m_out_end = nullptr;
 }
 
 File &File::operator=(File &&other) noexcept
 {
 	this->close();
+	m_path = std::move(other.m_path);
 	m_handle = other.handle();
 	m_mode = other.m_mode;
 	m_enc = other.m_enc;
 	m_owned = other.m_owned;
+	m_buffer = std::move(other.m_buffer);
+	m_buffer_pos = other.m_buffer_pos;
+	m_buffer_end = other.m_buffer_end;
+	m_out = std::move(other.m_out);
+	m_out_pos = other.m_out_pos;
+	m_out_end = other.m_out_end;
+	m_out_capacity = other.m_out_capacity;
 
 	other.m_handle = nullptr;
+	other.m_buffer_pos = other.m_buffer_end = nullptr;
+	other.m_out_pos = other.m_out_end = nullptr;
 
 	return *this;
 }
@@ -304,7 +326,7 @@ char16_t File::get_char_utf16()
 {
 	char16_t c = 0;
 
-	if (fread(&c, 2, 1, m_handle) != 1 || feof(m_handle))
+	if (read_buffered(&c, 2) != 2)
 	{
 		return Eof;
 	}
@@ -316,7 +338,7 @@ char32_t File::get_char_utf32()
 {
 	char32_t c = 0;
 
-	if (fread(&c, 4, 1, m_handle) != 1 || feof(m_handle))
+	if (read_buffered(&c, 4) != 4)
 	{
 		return Eof;
 	}
@@ -327,56 +349,181 @@ char32_t File::get_char_utf32()
 void File::rewind()
 {
     check_handle();
+	flush_output();
+	sync_buffer();
 	std::rewind(m_handle);
 }
 
 void File::seek(intptr_t pos)
 {
 	check_handle();
+	flush_output();
+	sync_buffer();
 	std::fseek(m_handle, pos, SEEK_SET);
 }
 
 intptr_t File::tell()
 {
-	return std::ftell(m_handle);
+	check_handle();
+	return std::ftell(m_handle) - buffered_count() + pending_count();
+}
+
+bool File::fill_buffer()
+{
+	// Output must be flushed before switching to input.
+	if (pending_count() != 0)
+	{
+		flush_output();
+		fflush(m_handle);
+	}
+	if (!m_buffer) {
+		m_buffer = std::make_unique<char[]>(BufferSize);
+	}
+	auto buffer = m_buffer.get();
+	size_t count;
+
+	if (m_owned)
+	{
+		count = fread(buffer, 1, BufferSize, m_handle);
+	}
+	else
+	{
+		// We don't own the handle, which may be a terminal or a pipe (e.g. stdin): don't try to read past the end
+		// of the current line, since this may block. We count the bytes as we go rather than using fgets() and
+		// strlen(), which would truncate lines that contain a NUL byte.
+		count = 0;
+		int c;
+		while (count < BufferSize && (c = getc(m_handle)) != EOF)
+		{
+			buffer[count++] = char(c);
+			if (c == '\n') break;
+		}
+	}
+	m_buffer_pos = buffer;
+	m_buffer_end = buffer + count;
+
+	return count != 0;
+}
+
+void File::sync_buffer()
+{
+	if (m_buffer_pos != m_buffer_end) {
+		std::fseek(m_handle, -long(buffered_count()), SEEK_CUR);
+	}
+	m_buffer_pos = m_buffer_end = nullptr;
+}
+
+size_t File::read_buffered(void *dest, size_t count)
+{
+	auto out = reinterpret_cast<char*>(dest);
+	size_t total = 0;
+
+	while (total < count)
+	{
+		if (m_buffer_pos == m_buffer_end && !fill_buffer()) {
+			break;
+		}
+		auto n = (std::min)(count - total, size_t(buffered_count()));
+		memcpy(out + total, m_buffer_pos, n);
+		m_buffer_pos += n;
+		total += n;
+	}
+
+	return total;
 }
 
 String File::read_line_utf8()
 {
-    const size_t limit = 32;
-    char buffer[limit];
-	size_t pos = 0;
-	char ch = 0;
-	bool fetch_next = true;
+	// Fast path: the whole line is in the buffer, so we can create the string in one go.
+	if (m_buffer_pos != m_buffer_end || fill_buffer())
+	{
+		auto eol = reinterpret_cast<char*>(memchr(m_buffer_pos, '\n', buffered_count()));
+
+		if (eol)
+		{
+			String line(m_buffer_pos, intptr_t(eol + 1 - m_buffer_pos));
+			m_buffer_pos = eol + 1;
+
+			return line;
+		}
+	}
+
 	String line;
+	read_line_utf8(line);
 
-	while (fetch_next)
+	return line;
+}
+
+void File::read_line_utf8(String &line)
+{
+	line.clear(false);
+
+	while (m_buffer_pos != m_buffer_end || fill_buffer())
 	{
-		ch = (char) fgetc(m_handle);
+		auto eol = reinterpret_cast<char*>(memchr(m_buffer_pos, '\n', buffered_count()));
 
-		if (ch != EOF)
+		if (eol)
 		{
-			if (pos < limit)
-			{
-				buffer[pos++] = ch;
-			}
-			else
-			{
-				line.append({ buffer, limit });
-                buffer[0] = ch;
-                pos = 1;
-			}
+			line.append({ m_buffer_pos, size_t(eol + 1 - m_buffer_pos) });
+			m_buffer_pos = eol + 1;
+			return;
 		}
 
-		if ((ch == '\n') || (ch == EOF))
+		// The line continues in the next chunk.
+		line.append({ m_buffer_pos, size_t(buffered_count()) });
+		m_buffer_pos = m_buffer_end;
+	}
+}
+
+String File::read_remaining_utf8()
+{
+	const bool at_start = (tell() == 0);
+	String text;
+
+	if (m_owned)
+	{
+		intptr_t buffered = buffered_count();
+		auto current_pos = std::ftell(m_handle);
+		intptr_t remaining = (current_pos < 0) ? 0 : (std::max<intptr_t>)(size() - current_pos, 0);
+		intptr_t total = buffered + remaining;
+
+		text = String(total + 1);
+		auto data = text.chars();
+
+		if (buffered)
+		{
+			memcpy(data, m_buffer_pos, size_t(buffered));
+			m_buffer_pos = m_buffer_end = nullptr;
+		}
+		auto count = remaining ? fread(data + buffered, 1, size_t(remaining), m_handle) : 0;
+		text.adjust(buffered + intptr_t(count));
+
+		// The file may have grown since we checked its size.
+		while (fill_buffer())
+		{
+			text.append({ m_buffer_pos, size_t(buffered_count()) });
+			m_buffer_pos = m_buffer_end;
+		}
+	}
+	else
+	{
+		while (m_buffer_pos != m_buffer_end || fill_buffer())
 		{
-			fetch_next = false;
-            //buffer[pos] = '\0';
-			line.append({ buffer, pos });
+			text.append({ m_buffer_pos, size_t(buffered_count()) });
+			m_buffer_pos = m_buffer_end;
 		}
 	}
 
-    return line;
+	// Files opened with an explicit encoding don't skip the byte order mark.
+	if (at_start && text.size() >= 3 && memcmp(text.data(), BOM_UTF8, 3) == 0)
+	{
+		auto data = text.chars();
+		auto size = text.size() - 3;
+		memmove(data, data + 3, size_t(size));
+		text.adjust(size);
+	}
+
+	return text;
 }
 
 String File::read_line_utf16()
@@ -462,59 +609,145 @@ String File::read_line_utf32()
 
 void File::close()
 {
+	if (m_handle != nullptr) {
+		flush_output();
+	}
 	if (m_owned && m_handle != nullptr)
 	{
 		fclose(m_handle);
 		m_handle = nullptr;
 	}
+	m_out.reset();
+	m_out_pos = m_out_end = nullptr;
 }
 
 bool File::at_end()
 {
     check_handle();
+
+	if (m_buffer_pos != m_buffer_end) {
+		return false;
+	}
+	if (readable()) {
+		return !fill_buffer();
+	}
+
 	return feof(m_handle) != 0;
 }
 
 void File::write(const char *text)
 {
-    check_handle();
-    fputs(text, m_handle);
+	write(text, strlen(text));
 }
 
 void File::write(char c)
 {
-	check_handle();
-	fputc(c, m_handle);
+	write(&c, 1);
 }
 
 void File::write(const String &text)
 {
-    write(text.data());
+	write(text.data(), size_t(text.size()));
 }
 
-void File::write_line(const char *text)
+void File::write(const char *text, size_t len)
+{
+	check_handle();
+	sync_buffer();
+	if (len == 0) return;
+
+	if (size_t(m_out_end - m_out_pos) < len)
+	{
+		flush_output();
+
+		// Large chunks bypass the buffer.
+		if (len >= m_out_capacity)
+		{
+			fwrite(text, 1, len, m_handle);
+			return;
+		}
+		if (!m_out)
+		{
+			m_out = std::make_unique<char[]>(m_out_capacity);
+			m_out_pos = m_out.get();
+			m_out_end = m_out_pos + m_out_capacity;
+		}
+	}
+	memcpy(m_out_pos, text, len);
+	m_out_pos += len;
+}
+
+void File::write_eol()
 {
-    check_handle();
-	fputs(text, m_handle);
 #if PHON_WINDOWS
-    fputc('\r', m_handle);
+	write("\r\n", 2);
+#else
+	write('\n');
 #endif
-    fputc('\n', m_handle);
+}
+
+void File::write_line(const char *text)
+{
+	write(text);
+	write_eol();
 }
 
 void File::write_line(const String &text)
 {
-    write_line(text.data());
+	write(text);
+	write_eol();
+}
+
+bool File::flush_output()
+{
+	auto count = size_t(pending_count());
+
+	if (count == 0) {
+		return true;
+	}
+	m_out_pos = m_out.get();
+
+	return fwrite(m_out.get(), 1, count, m_handle) == count;
+}
+
+void File::flush()
+{
+	check_handle();
+
+	if (!flush_output() || fflush(m_handle) != 0) {
+		throw error("Could not write to file \"%\"", m_path);
+	}
+}
+
+void File::set_buffer_size(size_t size)
+{
+	check_handle();
+	flush_output();
+	m_out.reset();
+	m_out_pos = m_out_end = nullptr;
+	m_out_capacity = size;
 }
 
 String File::read_all(const String &path, Encoding enc)
 {
-	String line, text;
 	File infile(path, Read, enc);
+	return infile.read_all();
+}
+
+String File::read_all()
+{
+	check_handle();
+
+	if (is_utf8())
+	{
+		return read_remaining_utf8();
+	}
 
-	while (!infile.at_end())
+	String text;
+
+	while (!this->at_end())
 	{
-		text.append(infile.read_line());
+		text.append(read_line());
 	}
 
 	return text;
@@ -525,6 +758,28 @@ Array<String> File::read_lines()
     check_handle();
 	Array<String> lines;
 
+	if (is_utf8() && m_owned)
+	{
+		// Read the whole file at once and split the buffer with memchr. Lines can't share the buffer, since a slice must
+		// be null-terminated and a short line that outlives the others would keep the whole file alive (see
+		// String::slice()). Each line is copied once to a buffer of exactly its size, except the last one, which is
+		// shared if it makes up most of the file.
+		auto text = read_remaining_utf8();
+		auto pos = text.data();
+		auto end = pos + text.size();
+
+		while (pos < end)
+		{
+			auto eol = reinterpret_cast<const char*>(memchr(pos, '\n', size_t(end - pos)));
+			auto next = eol ? eol + 1 : end;
+			auto len = intptr_t(next - pos);
+			lines.append(next == end ? text.slice(pos, len) : String::fragment(pos, len));
+			pos = next;
+		}
+
+		return lines;
+	}
+
 	while (!this->at_end())
 	{
 		lines.append(read_line());
@@ -555,16 +810,32 @@ String File::read_line()
 	}
 }
 
+void File::read_line(String &line)
+{
+	check_handle();
+
+	if (m_enc == Encoding::Utf8) {
+		read_line_utf8(line);
+	}
+	else {
+		line = read_line();
+	}
+}
+
 int File::read_byte()
 {
     check_handle();
-	return fgetc(m_handle);
+
+	if (m_buffer_pos == m_buffer_end && !fill_buffer()) {
+		return EOF;
+	}
+
+	return (unsigned char) *m_buffer_pos++;
 }
 
 void File::write_byte(int c)
 {
-    check_handle();
-	fputc((char) c, m_handle);
+	write(char(c));
 }
 
 bool File::operator==(const File &other) const
@@ -593,10 +864,12 @@ void File::format(const char *fmt, ...)
 	va_list args;
 
 	va_start(args, fmt);
-	vsnprintf(buffer, sizeof(buffer), fmt, args);
+	auto len = vsnprintf(buffer, sizeof(buffer), fmt, args);
 	va_end(args);
 
-	fputs(buffer, m_handle);
+	if (len > 0) {
+		write(buffer, (std::min)(size_t(len), sizeof(buffer) - 1));
+	}
 }
 
 } // namespace phonometrica
@@ -17,6 +17,7 @@
 
 #include <cstdio>
 #include <array>
+#include <memory>
 #include <phon/string.hpp>
 
 namespace phonometrica {
@@ -115,22 +116,41 @@ public:
 
 	void write(const String &text);
 
+	// Write raw bytes to this file.
+	void write(const char *text, size_t len);
+
 	// Write a string to this file and add a line ending
 	void write_line(const char *text);
 
 	void write_line(const String &text);
 
+	// Write the platform's line ending.
+	void write_eol();
+
+	// Push buffered output to the operating system.
+	void flush();
+
+	// Set the size of the output buffer. A size of 0 passes writes directly to the C stream. Files opened from a path
+	// are buffered by default, whereas handles we don't own (e.g. stdout) are not, so that their output is not delayed.
+	void set_buffer_size(size_t size);
+
 	void format(const char *fmt, ...);
 
 	// Read a file at once into one large string
 	static String read_all(const String &path, Encoding enc = Encoding::Undefined);
 
+	// Read the rest of the file into one large string
+	String read_all();
+
 	// Get the lines in a file
 	Array<String> read_lines();
 
 	// Read one line from the file, converting it to UTF8 on the fly
 	String read_line();
 
+	// Same as above, but reuse the storage of an existing string if possible.
+	void read_line(String &line);
+
 	int read_byte();
 
 	void write_byte(int c);
@@ -149,6 +169,30 @@ private:
 
 	String read_line_utf8();
 
+	void read_line_utf8(String &line);
+
+	// Read everything from the current position to the end of the file as raw bytes. For files we own, the string is
+	// allocated once and filled with a single read.
+	String read_remaining_utf8();
+
+	// Refill the read buffer. Returns false if there was nothing left to read.
+	bool fill_buffer();
+
+	// Discard data which has been buffered but not consumed yet, and move the file position back accordingly.
+	// This must be called before any operation which accesses the file handle directly.
+	void sync_buffer();
+
+	// Read up to `count` bytes through the read buffer, and return the number of bytes read.
+	size_t read_buffered(void *dest, size_t count);
+
+	intptr_t buffered_count() const { return m_buffer_end - m_buffer_pos; }
+
+	// Number of bytes waiting in the output buffer.
+	intptr_t pending_count() const { return m_out_pos - m_out.get(); }
+
+	// Write pending output to the file handle. Returns false if the data could not be written.
+	bool flush_output();
+
 	String read_line_utf16();
 
 	String read_line_utf32();
@@ -182,6 +226,21 @@ private:
 
 	bool m_owned = true; // whether we own the file handle.
 
+	// Read buffer, allocated on the first read. Data in [m_buffer_pos, m_buffer_end) has been read from the file
+	// handle but not consumed yet.
+	std::unique_ptr<char[]> m_buffer;
+	char *m_buffer_pos = nullptr;
+	char *m_buffer_end = nullptr;
+
+	// Output buffer, allocated on the first write. Data in [m_out, m_out_pos) has not been written to the file
+	// handle yet.
+	std::unique_ptr<char[]> m_out;
+	char *m_out_pos = nullptr;
+	char *m_out_end = nullptr;
+	size_t m_out_capacity = 0;
+
+	static constexpr size_t BufferSize = 65536;
+
 	static bool is_low_surrogate(char16_t c)
 	{
 		return c >= 0xDC00 && c <= 0xDFFF;
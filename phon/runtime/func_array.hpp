@@ -16,6 +16,7 @@
 #define PHONOMETRICA_FUNC_ARRAY_HPP
 
 #include <phon/runtime/runtime.hpp>
+#include <phon/utils/vector_math.hpp>
 
 namespace phonometrica {
 
@@ -131,28 +132,227 @@ static Variant array_set_item2(Runtime &rt, std::span<Variant> args)
 
 static Variant array_min(Runtime &, std::span<Variant> args)
 {
-	auto minimum = (std::numeric_limits<double>::max)();
 	auto &array = raw_cast<Array<double>>(args[0]);
-	for (intptr_t i = 1; i <= array.size(); i++)
-	{
-		auto value = array[i];
-		if (value < minimum) minimum = value;
+	auto i = utils::vector_argmin(array.data(), array.size());
+	if (i < 0) {
+		throw error("[Index error] Cannot get minimum of an empty array");
 	}
 
-	return minimum;
+	return array.data()[i];
 }
 
 static Variant array_max(Runtime &, std::span<Variant> args)
 {
-	auto maximum = (std::numeric_limits<double>::min)();
 	auto &array = raw_cast<Array<double>>(args[0]);
-	for (intptr_t i = 1; i <= array.size(); i++)
+	auto i = utils::vector_argmax(array.data(), array.size());
+	if (i < 0) {
+		throw error("[Index error] Cannot get maximum of an empty array");
+	}
+
+	return array.data()[i];
+}
+
+static Variant array_argmin(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	auto i = utils::vector_argmin(array.data(), array.size());
+
+	return i + 1; // 0 if not found
+}
+
+static Variant array_argmax(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	auto i = utils::vector_argmax(array.data(), array.size());
+
+	return i + 1; // 0 if not found
+}
+
+static Variant array_sum(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	return utils::vector_sum(array.data(), array.size());
+}
+
+static Variant array_mean(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	if (array.empty()) {
+		throw error("[Math error] Cannot compute the mean of an empty array");
+	}
+
+	return utils::vector_sum(array.data(), array.size()) / array.size();
+}
+
+// Sample variance (normalized by n-1).
+static Variant array_variance(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	auto n = array.size();
+	if (n < 2) {
+		throw error("[Math error] Cannot compute the variance of an array with fewer than 2 elements");
+	}
+	auto mean = utils::vector_sum(array.data(), n) / n;
+
+	return utils::vector_sum_squares(array.data(), n, mean) / (n - 1);
+}
+
+static Variant array_dot(Runtime &, std::span<Variant> args)
+{
+	auto &x = raw_cast<Array<double>>(args[0]);
+	auto &y = raw_cast<Array<double>>(args[1]);
+	if (x.size() != y.size()) {
+		throw error("[Index error] Cannot compute the dot product of arrays with % and % elements", x.size(), y.size());
+	}
+
+	return utils::vector_dot(x.data(), y.data(), x.size());
+}
+
+static Variant array_cumsum(Runtime &, std::span<Variant> args)
+{
+	Array<double> result(raw_cast<Array<double>>(args[0]));
+	utils::vector_cumsum(result.data(), result.data(), result.size());
+
+	return make_handle<Array<double>>(std::move(result));
+}
+
+static Variant array_sqrt(Runtime &, std::span<Variant> args)
+{
+	Array<double> result(raw_cast<Array<double>>(args[0]));
+	utils::vector_sqrt(result.data(), result.data(), result.size());
+
+	return make_handle<Array<double>>(std::move(result));
+}
+
+static Variant array_matmul(Runtime &, std::span<Variant> args)
+{
+	auto &a = raw_cast<Array<double>>(args[0]);
+	auto &b = raw_cast<Array<double>>(args[1]);
+	if (a.ndim() > 2 || b.ndim() > 2) {
+		throw error("[Index error] Matrix multiplication requires arrays with at most 2 dimensions");
+	}
+	if (a.ncol() != b.nrow()) {
+		throw error("[Index error] Cannot multiply a % x % matrix by a % x % matrix", a.nrow(), a.ncol(), b.nrow(), b.ncol());
+	}
+	Array<double> result(a.nrow(), b.ncol(), 0.0);
+	utils::matrix_multiply(a.data(), b.data(), result.data(), a.nrow(), a.ncol(), b.ncol());
+
+	return make_handle<Array<double>>(std::move(result));
+}
+
+static Variant array_transpose(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	if (array.ndim() > 2) {
+		throw error("[Index error] Cannot transpose an array with % dimensions", array.ndim());
+	}
+	Array<double> result(array.ncol(), array.nrow());
+	utils::matrix_transpose(array.data(), result.data(), array.nrow(), array.ncol());
+
+	return make_handle<Array<double>>(std::move(result));
+}
+
+// Return a copy of row i. Rows are not contiguous in column-major storage, so they can't be shared with the matrix.
+static Variant array_get_row(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	intptr_t i = raw_cast<intptr_t>(args[1]);
+	if (array.ndim() != 2) {
+		throw error("[Index error] Cannot get a row in an array with % dimension(s)", array.ndim());
+	}
+	auto ncol = array.ncol();
+	Array<double> result(ncol, 0.0);
+	for (intptr_t j = 1; j <= ncol; j++) {
+		result[j] = array.at(i, j);
+	}
+
+	return make_handle<Array<double>>(std::move(result));
+}
+
+// Return a copy of column j. Arrays own their buffer, so the result is not a view: modifying it doesn't modify the matrix.
+static Variant array_get_column(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	intptr_t j = raw_cast<intptr_t>(args[1]);
+	if (array.ndim() != 2) {
+		throw error("[Index error] Cannot get a column in an array with % dimension(s)", array.ndim());
+	}
+	// Columns are contiguous.
+	auto nrow = array.nrow();
+	auto first = &array.at(1, j);
+
+	return make_handle<Array<double>>(std::span<double>(first, nrow));
+}
+
+static Variant array_reshape(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	intptr_t nrow = raw_cast<intptr_t>(args[1]);
+	intptr_t ncol = raw_cast<intptr_t>(args[2]);
+	if (array.ndim() > 2) {
+		throw error("[Index error] Cannot reshape an array with % dimensions", array.ndim());
+	}
+	if (nrow < 0 || ncol < 0 || nrow * ncol != array.size()) {
+		throw error("[Index error] Cannot reshape an array with % elements to % x %", array.size(), nrow, ncol);
+	}
+	// Since the data is stored in column-major order, the new matrix is filled column by column.
+	Array<double> result(nrow, ncol);
+	std::copy(array.begin(), array.end(), result.begin());
+
+	return make_handle<Array<double>>(std::move(result));
+}
+
+static Variant array_row_sums(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	if (array.ndim() > 2) {
+		throw error("[Index error] Cannot compute row sums in an array with % dimensions", array.ndim());
+	}
+	auto nrow = array.nrow();
+	Array<double> result(nrow, 0.0);
+	// Columns are contiguous. Don't take the address of element (1, j), which doesn't exist if there are no rows.
+	for (intptr_t j = 0; nrow > 0 && j < array.ncol(); j++)
 	{
-		auto value = array[i];
-		if (value > maximum) maximum = value;
+		auto column = array.data() + j * nrow;
+		utils::vector_op('+', result.data(), column, result.data(), nrow);
+	}
+
+	return make_handle<Array<double>>(std::move(result));
+}
+
+static Variant array_column_sums(Runtime &, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	if (array.ndim() > 2) {
+		throw error("[Index error] Cannot compute column sums in an array with % dimensions", array.ndim());
+	}
+	auto nrow = array.nrow();
+	Array<double> result(array.ncol(), 0.0);
+	for (intptr_t j = 0; nrow > 0 && j < array.ncol(); j++) {
+		result[j + 1] = utils::vector_sum(array.data() + j * nrow, nrow);
 	}
 
-	return maximum;
+	return make_handle<Array<double>>(std::move(result));
+}
+
+static Variant array_row_means(Runtime &rt, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	auto sums = array_row_sums(rt, args);
+	auto &result = raw_cast<Array<double>>(sums);
+	utils::vector_op('/', result.data(), double(array.ncol()), result.data(), result.size());
+
+	return sums;
+}
+
+static Variant array_column_means(Runtime &rt, std::span<Variant> args)
+{
+	auto &array = raw_cast<Array<double>>(args[0]);
+	auto sums = array_column_sums(rt, args);
+	auto &result = raw_cast<Array<double>>(sums);
+	utils::vector_op('/', result.data(), double(array.nrow()), result.data(), result.size());
+
+	return sums;
 }
 
 static Variant array_clear(Runtime &, std::span<Variant> args)
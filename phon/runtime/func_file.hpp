@@ -15,6 +15,7 @@
 #ifndef PHONOMETRICA_FUNC_FILE_HPP
 #define PHONOMETRICA_FUNC_FILE_HPP
 
+#include <charconv>
 #include <phon/file.hpp>
 #include <phon/runtime/runtime.hpp>
 
@@ -63,17 +64,76 @@ static Variant file_write_line(Runtime &, std::span<Variant> args)
 	return Variant();
 }
 
-static Variant file_write_lines(Runtime &, std::span<Variant> args)
+namespace detail {
+
+// Write an item straight into the file's buffer: strings and integers don't need to be converted first.
+static void write_item(File &f, const Variant &item)
+{
+	if (check_type<String>(item))
+	{
+		f.write(raw_cast<String>(item));
+	}
+	else if (check_type<intptr_t>(item))
+	{
+		char buffer[32];
+		auto result = std::to_chars(buffer, buffer + sizeof(buffer), raw_cast<intptr_t>(item));
+		f.write(buffer, size_t(result.ptr - buffer));
+	}
+	else
+	{
+		f.write(item.to_string());
+	}
+}
+
+} // namespace detail
+
+static Variant file_write_lines1(Runtime &, std::span<Variant> args)
+{
+	auto &f = raw_cast<File>(args[0]);
+	auto &lines = raw_cast<List>(args[1]).items();
+	for (auto &line : lines)
+	{
+		detail::write_item(f, line);
+		f.write_eol();
+	}
+
+	return Variant();
+}
+
+static Variant file_write_lines2(Runtime &, std::span<Variant> args)
 {
 	auto &f = raw_cast<File>(args[0]);
 	auto &lines = raw_cast<List>(args[1]).items();
-	for (auto &line : lines) {
-		f.write_line(line.to_string());
+	auto &sep = raw_cast<String>(args[2]);
+	for (auto &line : lines)
+	{
+		detail::write_item(f, line);
+		f.write(sep);
 	}
 
 	return Variant();
 }
 
+static Variant file_flush(Runtime &, std::span<Variant> args)
+{
+	auto &f = raw_cast<File>(args[0]);
+	f.flush();
+
+	return Variant();
+}
+
+static Variant file_set_buffer_size(Runtime &, std::span<Variant> args)
+{
+	auto &f = raw_cast<File>(args[0]);
+	auto size = raw_cast<intptr_t>(args[1]);
+	if (size < 0) {
+		throw error("[Index error] Buffer size cannot be negative");
+	}
+	f.set_buffer_size(size_t(size));
+
+	return Variant();
+}
+
 static Variant file_write(Runtime &, std::span<Variant> args)
 {
 	auto &f = raw_cast<File>(args[0]);
@@ -102,14 +162,7 @@ static Variant file_rewind(Runtime &, std::span<Variant> args)
 static Variant file_read(Runtime &, std::span<Variant> args)
 {
 	auto &f = raw_cast<File>(args[0]);
-	String line, text;
-
-	while (!f.at_end())
-	{
-		text.append(f.read_line());
-	}
-
-	return text;
+	return f.read_all();
 }
 
 static Variant read_file(Runtime &, std::span<Variant> args)
@@ -52,10 +52,63 @@ static Variant get_length(Runtime &, std::span<Variant> args)
 	else if (check_type<File>(v)) {
 		return raw_cast<File>(v).size();
 	}
+	else if (check_type<Range>(v)) {
+		return raw_cast<Range>(v).size();
+	}
 
 	throw error("[Type error] Cannot get length of % value", v.class_name());
 }
 
+// Create an empty collection which can hold at least n elements without reallocating.
+static Variant with_capacity(Runtime &rt, std::span<Variant> args)
+{
+	auto &cls = raw_cast<Class>(args[0]);
+	auto n = raw_cast<intptr_t>(args[1]);
+	if (n < 0) {
+		throw error("[Index error] Capacity cannot be negative");
+	}
+
+	if (&cls == Class::get<List>())
+	{
+		List::Storage items;
+		items.reserve(n);
+		return make_handle<List>(&rt, std::move(items));
+	}
+	else if (&cls == Class::get<Table>())
+	{
+		Table::Storage map;
+		map.reserve(n);
+		return make_handle<Table>(&rt, std::move(map));
+	}
+
+	throw error("[Type error] Cannot create a % with a given capacity", cls.name());
+}
+
+// Call a function without arguments. Returns null if it succeeded, or a table with the error message and line number.
+static Variant catch_error(Runtime &rt, std::span<Variant> args)
+{
+	auto &func = raw_cast<Function>(args[0]);
+
+	try
+	{
+		rt.call_protected(func, {});
+	}
+	catch (RuntimeError &e)
+	{
+		// Scripts can't escape the limits set by the host.
+		if (rt.out_of_budget()) {
+			throw;
+		}
+		Table::Storage map;
+		map.insert({ String("message"), String(e.what()) });
+		map.insert({ String("line"), e.line_no() });
+
+		return make_handle<Table>(&rt, std::move(map));
+	}
+
+	return Variant();
+}
+
 static Variant to_string(Runtime &, std::span<Variant> args)
 {
 	return args[0].to_string();
@@ -17,7 +17,10 @@
 
 #include <algorithm>
 #include <random>
+#include <numeric>
+#include <cstring>
 #include <phon/runtime/runtime.hpp>
+#include <phon/utils/parallel_sort.hpp>
 
 namespace phonometrica {
 
@@ -149,10 +152,26 @@ static Variant list_join(Runtime &, std::span<Variant> args)
 	auto &lst = raw_cast<List>(args[0]).items();
 	auto &delim = raw_cast<String>(args[1]);
 	String result;
+	intptr_t size = 0;
+
+	// Reserve storage upfront for the common case where all the items are strings.
+	for (auto &item : lst)
+	{
+		auto &value = item.resolve();
+		size += (value.is_string() ? raw_cast<String>(value).size() : 0) + delim.size();
+	}
+	result.reserve(size);
 
 	for (intptr_t i = 1; i <= lst.size(); i++)
 	{
-		result.append(lst[i].to_string());
+		auto &value = lst[i].resolve();
+
+		if (value.is_string()) {
+			result.append(raw_cast<String>(value));
+		}
+		else {
+			result.append(value.to_string());
+		}
 		if (i != lst.size()) {
 			result.append(delim);
 		}
@@ -189,6 +208,49 @@ static Variant list_append(Runtime &, std::span<Variant> args)
 //	return Variant();
 //}
 
+static Variant list_extend(Runtime &, std::span<Variant> args)
+{
+	auto &lst = raw_cast<List>(args[0].unshare()).items();
+	auto &other_var = args[1].resolve();
+	auto &other = raw_cast<List>(other_var).items();
+
+	if (&lst == &other)
+	{
+		lst.append(List::Storage(other));
+		return Variant();
+	}
+
+	lst.reserve(lst.size() + other.size());
+
+	// If nobody else can see the other list, we can steal its items instead of copying them. References are always
+	// resolved, so that the two lists don't share any value.
+	bool steal = !other_var.shared();
+
+	for (auto &item : other)
+	{
+		if (steal && !item.is_alias()) {
+			lst.append(std::move(item));
+		}
+		else {
+			lst.append(item.resolve());
+		}
+	}
+
+	return Variant();
+}
+
+static Variant list_reserve(Runtime &, std::span<Variant> args)
+{
+	auto &lst = raw_cast<List>(args[0].unshare()).items();
+	auto n = raw_cast<intptr_t>(args[1]);
+	if (n < 0) {
+		throw error("[Index error] Capacity cannot be negative");
+	}
+	lst.reserve(n);
+
+	return Variant();
+}
+
 static Variant list_prepend(Runtime &, std::span<Variant> args)
 {
 	auto &lst = raw_cast<List>(args[0].unshare()).items();
@@ -230,10 +292,123 @@ static Variant list_shift(Runtime &, std::span<Variant> args)
 	return lst.take_first().resolve();
 }
 
-static Variant list_sort(Runtime &, std::span<Variant> args)
+namespace detail {
+
+// Sort a list according to a list of keys of the same size (the keys may be the items themselves). If all the keys are
+// integers, numbers or strings, they are extracted and compared natively, which allows large lists to be sorted in
+// parallel. Otherwise, we fall back to the generic comparison in the current thread.
+static void sort_by_keys(Array<Variant> &items, const Array<Variant> &keys, bool stable)
+{
+	assert(items.size() == keys.size());
+	intptr_t size = items.size();
+	bool all_int = true, all_num = true, all_str = true;
+
+	for (auto &k : keys)
+	{
+		auto &key = k.resolve();
+		all_int &= key.is_integer();
+		all_num &= key.is_number();
+		all_str &= key.is_string();
+		if (!all_num && !all_str) break;
+	}
+
+	// Positions of the items, in sorted order (0-based).
+	std::vector<intptr_t> order;
+	order.reserve(size);
+
+	auto sort_decorated = [&](auto &decorated) {
+		auto comp = [](const auto &a, const auto &b) { return a.first < b.first; };
+		utils::parallel_sort(decorated.begin(), decorated.end(), comp, stable);
+		for (auto &d : decorated) order.push_back(d.second);
+	};
+
+	if (all_int)
+	{
+		std::vector<std::pair<intptr_t, intptr_t>> decorated;
+		decorated.reserve(size);
+		for (intptr_t i = 1; i <= size; i++) decorated.emplace_back(raw_cast<intptr_t>(keys[i].resolve()), i - 1);
+		sort_decorated(decorated);
+	}
+	else if (all_num)
+	{
+		std::vector<std::pair<double, intptr_t>> decorated;
+		decorated.reserve(size);
+		for (intptr_t i = 1; i <= size; i++) decorated.emplace_back(keys[i].resolve().get_number(), i - 1);
+		sort_decorated(decorated);
+	}
+	else if (all_str)
+	{
+		// Same ordering as String::compare().
+		std::vector<std::pair<Substring, intptr_t>> decorated;
+		decorated.reserve(size);
+		for (intptr_t i = 1; i <= size; i++) decorated.emplace_back(raw_cast<String>(keys[i].resolve()).view(), i - 1);
+		sort_decorated(decorated);
+	}
+	else
+	{
+		order.resize(size);
+		std::iota(order.begin(), order.end(), 0);
+		auto comp = [&keys](intptr_t a, intptr_t b) { return keys[a+1] < keys[b+1]; };
+		if (stable) std::stable_sort(order.begin(), order.end(), comp); else std::sort(order.begin(), order.end(), comp);
+	}
+
+	// Undecorate.
+	Array<Variant> result;
+	result.reserve(size);
+	for (auto i : order) {
+		result.append(std::move(items[i+1]));
+	}
+	items.swap(result);
+}
+
+static Array<Variant> get_sort_keys(Runtime &rt, Array<Variant> &items, Function &func)
+{
+	Array<Variant> keys;
+	keys.reserve(items.size());
+
+	for (auto &item : items)
+	{
+		Variant arg = item.resolve();
+		keys.append(rt.call(func, { &arg, 1 }));
+	}
+
+	return keys;
+}
+
+} // namespace detail
+
+static Variant list_sort1(Runtime &, std::span<Variant> args)
+{
+	auto &lst = raw_cast<List>(args[0].unshare()).items();
+	detail::sort_by_keys(lst, lst, false);
+
+	return Variant();
+}
+
+static Variant list_sort2(Runtime &rt, std::span<Variant> args)
+{
+	auto &lst = raw_cast<List>(args[0].unshare()).items();
+	auto &func = raw_cast<Function>(args[1]);
+	auto keys = detail::get_sort_keys(rt, lst, func);
+	detail::sort_by_keys(lst, keys, false);
+
+	return Variant();
+}
+
+static Variant list_stable_sort1(Runtime &, std::span<Variant> args)
+{
+	auto &lst = raw_cast<List>(args[0].unshare()).items();
+	detail::sort_by_keys(lst, lst, true);
+
+	return Variant();
+}
+
+static Variant list_stable_sort2(Runtime &rt, std::span<Variant> args)
 {
 	auto &lst = raw_cast<List>(args[0].unshare()).items();
-	std::sort(lst.begin(), lst.end());
+	auto &func = raw_cast<Function>(args[1]);
+	auto keys = detail::get_sort_keys(rt, lst, func);
+	detail::sort_by_keys(lst, keys, true);
 
 	return Variant();
 }
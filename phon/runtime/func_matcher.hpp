@@ -0,0 +1,153 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: Matcher builtin functions.                                                                                *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+
+#ifndef PHONOMETRICA_FUNC_MATCHER_HPP
+#define PHONOMETRICA_FUNC_MATCHER_HPP
+
+#include <phon/regex.hpp>
+#include <phon/runtime/matcher.hpp>
+#include <phon/runtime/runtime.hpp>
+
+namespace phonometrica {
+
+namespace detail {
+
+static Array<String> get_patterns(const List &lst)
+{
+	Array<String> patterns;
+	patterns.reserve(lst.size());
+
+	for (auto &item : lst.items())
+	{
+		auto &value = item.resolve();
+		if (!value.is_string()) {
+			throw error("[Type error] Matcher patterns must be strings, not %", value.class_name());
+		}
+		patterns.append(raw_cast<String>(value));
+	}
+
+	return patterns;
+}
+
+} // namespace detail
+
+static Variant matcher_new1(Runtime &, std::span<Variant> args)
+{
+	auto &lst = raw_cast<List>(args[0]);
+	return make_handle<Matcher>(detail::get_patterns(lst));
+}
+
+static Variant matcher_new2(Runtime &, std::span<Variant> args)
+{
+	auto &lst = raw_cast<List>(args[0]);
+	auto &flags = raw_cast<String>(args[1]);
+	bool caseless = false;
+
+	for (auto &flag : flags.split("|"))
+	{
+		if (flag == "caseless") {
+			caseless = true;
+		}
+		else {
+			throw error("[Runtime error] Invalid Matcher option \"%\"", flag);
+		}
+	}
+
+	return make_handle<Matcher>(detail::get_patterns(lst), caseless);
+}
+
+static Variant matcher_get_field(Runtime &rt, std::span<Variant> args)
+{
+	auto &m = raw_cast<Matcher>(args[0]);
+	auto &key = raw_cast<String>(args[1]);
+	if (key == rt.length_string) {
+		return m.size();
+	}
+	else if (key == "caseless") {
+		return m.caseless();
+	}
+
+	throw error("[Index error] Matcher type has no member named \"%\"", key);
+}
+
+static Variant matcher_find_all(Runtime &rt, std::span<Variant> args)
+{
+	auto &m = raw_cast<Matcher>(args[0]);
+	auto &text = raw_cast<String>(args[1]);
+	auto s = reinterpret_cast<const unsigned char*>(text.data());
+	Array<Variant> result;
+	intptr_t anchor_byte = 0, anchor_char = 0;
+
+	m.scan(text, [&](intptr_t start, intptr_t end, intptr_t) {
+		// Matches are reported in order, so we can count code points incrementally.
+		for (; anchor_byte < start; anchor_byte++) {
+			anchor_char += ((s[anchor_byte] & 0xC0) != 0x80);
+		}
+		PCRE2_SIZE offsets[2] = { PCRE2_SIZE(start), PCRE2_SIZE(end) };
+		result.append(make_handle<Match>(text, offsets, 1, 1, anchor_byte, anchor_char));
+	});
+
+	return make_handle<List>(&rt, std::move(result));
+}
+
+static Variant matcher_count(Runtime &, std::span<Variant> args)
+{
+	auto &m = raw_cast<Matcher>(args[0]);
+	auto &text = raw_cast<String>(args[1]);
+
+	return m.count(text);
+}
+
+static Variant matcher_contains(Runtime &, std::span<Variant> args)
+{
+	auto &m = raw_cast<Matcher>(args[0]);
+	auto &text = raw_cast<String>(args[1]);
+
+	return m.contains(text);
+}
+
+static Variant matcher_replace1(Runtime &, std::span<Variant> args)
+{
+	auto &text = raw_cast<String>(args[0]);
+	auto &m = raw_cast<Matcher>(args[1]);
+	auto &replacement = raw_cast<String>(args[2]);
+	text = m.replace(text, replacement);
+
+	return Variant();
+}
+
+static Variant matcher_replace2(Runtime &, std::span<Variant> args)
+{
+	auto &text = raw_cast<String>(args[0]);
+	auto &m = raw_cast<Matcher>(args[1]);
+	auto &lst = raw_cast<List>(args[2]);
+
+	if (lst.size() != m.size()) {
+		throw error("[Index error] Expected % replacements, got %", m.size(), lst.size());
+	}
+	std::vector<String> replacements;
+	replacements.reserve(size_t(lst.size()));
+
+	for (auto &item : lst.items()) {
+		replacements.push_back(item.resolve().to_string());
+	}
+	text = m.replace(text, replacements);
+
+	return Variant();
+}
+
+} // namespace phonometrica
+
+#endif // PHONOMETRICA_FUNC_MATCHER_HPP
@@ -50,10 +50,11 @@ static Variant math_abs(Runtime &, std::span<Variant> args)
 template<double(*f)(double)>
 Variant math_array_func(Runtime &, std::span<Variant> args)
 {
-	auto &array = raw_cast<Array<double>>(args[0]);
-	Array<double> result(array.nrow(), array.ncol(), 0.0);
-	for (intptr_t i = 1; i <= array.size(); i++) {
-		result[i] = f(array[i]);
+	// Copy the array to preserve its shape, and update the values in place.
+	Array<double> result(raw_cast<Array<double>>(args[0]));
+	auto data = result.data();
+	for (intptr_t i = 0; i < result.size(); i++) {
+		data[i] = f(data[i]);
 	}
 
 	return make_handle<Array<double>>(std::move(result));
@@ -0,0 +1,112 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: Range builtin functions.                                                                                  *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef PHONOMETRICA_FUNC_RANGE_HPP
+#define PHONOMETRICA_FUNC_RANGE_HPP
+
+#include <phon/runtime/range.hpp>
+#include <phon/runtime/runtime.hpp>
+
+namespace phonometrica {
+
+static Variant range_new2(Runtime &, std::span<Variant> args)
+{
+	auto start = raw_cast<intptr_t>(args[0]);
+	auto stop = raw_cast<intptr_t>(args[1]);
+
+	return make_handle<Range>(start, stop);
+}
+
+static Variant range_new3(Runtime &, std::span<Variant> args)
+{
+	auto start = raw_cast<intptr_t>(args[0]);
+	auto stop = raw_cast<intptr_t>(args[1]);
+	auto step = raw_cast<intptr_t>(args[2]);
+
+	return make_handle<Range>(start, stop, step);
+}
+
+static Variant range_get_item(Runtime &rt, std::span<Variant> args)
+{
+	if (rt.needs_reference()) {
+		throw error("[Reference error] Range elements cannot be passed by reference");
+	}
+	if (args.size() > 2) {
+		throw error("[Index error] Range does not support multidimensional indexing");
+	}
+	auto &range = raw_cast<Range>(args[0]);
+	auto i = raw_cast<intptr_t>(args[1]);
+
+	return range.at(i);
+}
+
+static Variant range_get_field(Runtime &rt, std::span<Variant> args)
+{
+	auto &range = raw_cast<Range>(args[0]);
+	auto &key = raw_cast<String>(args[1]);
+
+	if (key == rt.length_string) {
+		return range.size();
+	}
+	else if (key == "start") {
+		return range.start();
+	}
+	else if (key == "stop") {
+		return range.stop();
+	}
+	else if (key == "step") {
+		return range.step();
+	}
+	else if (key == "first") {
+		return range.at(1);
+	}
+	else if (key == "last") {
+		return range.at(-1);
+	}
+
+	throw error("[Index error] Range type has no member named \"%\"", key);
+}
+
+static Variant range_contains(Runtime &, std::span<Variant> args)
+{
+	auto &range = raw_cast<Range>(args[0]);
+	auto &v = args[1].resolve();
+
+	if (v.is_integer()) {
+		return range.contains(raw_cast<intptr_t>(v));
+	}
+	else if (v.is_float())
+	{
+		auto x = raw_cast<double>(v);
+		return std::floor(x) == x && range.contains(intptr_t(x));
+	}
+
+	return false;
+}
+
+static Variant range_is_empty(Runtime &, std::span<Variant> args)
+{
+	return raw_cast<Range>(args[0]).empty();
+}
+
+// Materialize a range as a list.
+static Variant range_to_list(Runtime &rt, std::span<Variant> args)
+{
+	auto &range = raw_cast<Range>(args[0]);
+	return make_handle<List>(&rt, range.to_list());
+}
+
+} // namespace phonometrica
+
+#endif // PHONOMETRICA_FUNC_RANGE_HPP
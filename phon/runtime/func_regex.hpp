@@ -17,6 +17,7 @@
 
 #include <phon/regex.hpp>
 #include <phon/runtime/runtime.hpp>
+#include <phon/runtime/iterator.hpp>
 
 namespace phonometrica {
 
@@ -112,6 +113,88 @@ static Variant regex_get_end(Runtime &, std::span<Variant> args)
 	return regex.capture_end(i);
 }
 
+static Variant regex_find_all(Runtime &, std::span<Variant> args)
+{
+	auto &subject = raw_cast<String>(args[1]);
+	return make_handle<RegexIterator>(args[0].resolve(), subject);
+}
+
+static Variant regex_cache_stats(Runtime &rt, std::span<Variant>)
+{
+	auto stats = Regex::cache_stats();
+	Table::Storage map;
+	map.reserve(4);
+	map.insert({ String("size"), stats.size });
+	map.insert({ String("capacity"), stats.capacity });
+	map.insert({ String("hits"), stats.hits });
+	map.insert({ String("misses"), stats.misses });
+
+	return make_handle<Table>(&rt, std::move(map));
+}
+
+static Variant regex_set_cache_capacity(Runtime &, std::span<Variant> args)
+{
+	auto n = raw_cast<intptr_t>(args[0]);
+	if (n < 0) {
+		throw error("[Index error] Capacity cannot be negative");
+	}
+	Regex::set_cache_capacity(n);
+
+	return Variant();
+}
+
+static Variant regex_set_jit_stack_size(Runtime &, std::span<Variant> args)
+{
+	auto n = raw_cast<intptr_t>(args[0]);
+	if (n < 0) {
+		throw error("[Index error] Stack size cannot be negative");
+	}
+	Regex::set_jit_stack_size(size_t(n));
+
+	return Variant();
+}
+
+static Variant match_get_field(Runtime &rt, std::span<Variant> args)
+{
+	auto &m = raw_cast<Match>(args[0]);
+	auto &key = raw_cast<String>(args[1]);
+	if (key == rt.length_string) {
+		return m.count();
+	}
+	else if (key == "value") {
+		return m.group(0);
+	}
+	else if (key == "subject") {
+		return m.subject();
+	}
+
+	throw error("[Index error] Match type has no member named \"%\"", key);
+}
+
+static Variant match_count(Runtime &, std::span<Variant> args)
+{
+	auto &m = raw_cast<Match>(args[0]);
+	return m.count();
+}
+
+static Variant match_group(Runtime &, std::span<Variant> args)
+{
+	auto &m = raw_cast<Match>(args[0]);
+	return m.group(raw_cast<intptr_t>(args[1]));
+}
+
+static Variant match_get_start(Runtime &, std::span<Variant> args)
+{
+	auto &m = raw_cast<Match>(args[0]);
+	return m.start(raw_cast<intptr_t>(args[1]));
+}
+
+static Variant match_get_end(Runtime &, std::span<Variant> args)
+{
+	auto &m = raw_cast<Match>(args[0]);
+	return m.end(raw_cast<intptr_t>(args[1]));
+}
+
 } // namespace phonometrica
 
 #endif // PHONOMETRICA_FUNC_REGEX_HPP
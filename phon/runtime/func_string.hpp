@@ -16,6 +16,7 @@
 #define PHONOMETRICA_FUNC_STRING_HPP
 
 #include <phon/runtime/runtime.hpp>
+#include <phon/regex.hpp>
 
 namespace phonometrica {
 
@@ -120,7 +121,7 @@ static Variant string_slice1(Runtime &, std::span<Variant> args)
 	auto &s1 = raw_cast<String>(args[0]);
 	auto from = raw_cast<intptr_t>(args[1]);
 
-	return s1.mid(from);
+	return s1.slice(s1.mid(from));
 }
 
 static Variant string_slice2(Runtime &, std::span<Variant> args)
@@ -129,7 +130,7 @@ static Variant string_slice2(Runtime &, std::span<Variant> args)
 	auto from = raw_cast<intptr_t>(args[1]);
 	auto count = raw_cast<intptr_t>(args[2]);
 
-	return s1.mid(from, count);
+	return s1.slice(s1.mid(from, count));
 }
 
 static Variant string_count(Runtime &, std::span<Variant> args)
@@ -178,8 +179,24 @@ static Variant string_split(Runtime &rt, std::span<Variant> args)
 {
 	auto &s = raw_cast<String>(args[0]);
 	auto &delim = raw_cast<String>(args[1]);
+	auto parts = s.split(delim);
 	Array<Variant> result;
-	for (auto &p : s.split(delim)) {
+	result.reserve(parts.size());
+	for (auto &p : parts) {
+		result.append(std::move(p));
+	}
+
+	return make_handle<List>(&rt, std::move(result));
+}
+
+static Variant string_split_regex(Runtime &rt, std::span<Variant> args)
+{
+	auto &s = raw_cast<String>(args[0]);
+	auto &re = raw_cast<Regex>(args[1]);
+	auto parts = re.split(s);
+	Array<Variant> result;
+	result.reserve(parts.size());
+	for (auto &p : parts) {
 		result.append(std::move(p));
 	}
 
@@ -285,6 +302,26 @@ static Variant string_replace(Runtime &, std::span<Variant> args)
 	return Variant();
 }
 
+static Variant string_replace_regex(Runtime &, std::span<Variant> args)
+{
+	auto &s1 = raw_cast<String>(args[0]);
+	auto &re = raw_cast<Regex>(args[1]);
+	auto &s2 = raw_cast<String>(args[2]);
+	s1 = re.replace(s1, s2);
+
+	return Variant();
+}
+
+static Variant string_replace_first_regex(Runtime &, std::span<Variant> args)
+{
+	auto &s1 = raw_cast<String>(args[0]);
+	auto &re = raw_cast<Regex>(args[1]);
+	auto &s2 = raw_cast<String>(args[2]);
+	s1 = re.replace(s1, s2, 1);
+
+	return Variant();
+}
+
 static Variant string_replace_first(Runtime &, std::span<Variant> args)
 {
 	auto &s1 = raw_cast<String>(args[0]);
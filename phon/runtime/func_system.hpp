@@ -288,6 +288,54 @@ static Variant system_find_module(Runtime &, std::span<Variant> args)
 }
 #endif
 
+static Variant make_memory_usage(Runtime &rt, const utils::MemoryUsage &usage)
+{
+	Table::Storage map;
+	map.reserve(4);
+	map.insert({ String("blocks"), usage.blocks });
+	map.insert({ String("bytes"), usage.bytes });
+	map.insert({ String("allocations"), usage.allocations });
+	map.insert({ String("allocated_bytes"), usage.allocated_bytes });
+
+	return make_handle<Table>(&rt, std::move(map));
+}
+
+static Variant system_enable_memory_stats(Runtime &rt, std::span<Variant>)
+{
+	rt.enable_memory_stats();
+	return Variant();
+}
+
+static Variant system_memory_stats(Runtime &rt, std::span<Variant>)
+{
+	auto tracker = rt.memory_stats();
+	if (!tracker) {
+		return Variant();
+	}
+
+	Table::Storage map;
+	for (size_t i = 0; i < utils::MEMORY_CATEGORY_COUNT; i++)
+	{
+		auto category = static_cast<utils::MemoryCategory>(i);
+		map.insert({ String(utils::MemoryTracker::get_category_name(category)), make_memory_usage(rt, tracker->usage(category)) });
+	}
+	map.insert({ String("total"), make_memory_usage(rt, tracker->total()) });
+	map.insert({ String("peak"), tracker->peak() });
+	map.insert({ String("limit"), tracker->limit() });
+
+	Table::Storage classes;
+	for (auto &cls : rt.get_classes())
+	{
+		auto &usage = cls->memory_usage();
+		if (usage.allocations > 0) {
+			classes.insert({ cls->name(), make_memory_usage(rt, usage) });
+		}
+	}
+	map.insert({ String("classes"), make_handle<Table>(&rt, std::move(classes)) });
+
+	return make_handle<Table>(&rt, std::move(map));
+}
+
 static Variant system_genericize(Runtime &, std::span<Variant> args)
 {
 	auto &path = raw_cast<String>(args[0]);
@@ -63,6 +63,18 @@ static Variant table_contains(Runtime &, std::span<Variant> args)
 	return map.contains(args[1]);
 }
 
+static Variant table_reserve(Runtime &, std::span<Variant> args)
+{
+	auto &map = raw_cast<Table>(args[0].unshare()).map();
+	auto n = raw_cast<intptr_t>(args[1]);
+	if (n < 0) {
+		throw error("[Index error] Capacity cannot be negative");
+	}
+	map.reserve(n);
+
+	return Variant();
+}
+
 static Variant table_is_empty(Runtime &, std::span<Variant> args)
 {
 	auto &map = raw_cast<Table>(args[0]).map();
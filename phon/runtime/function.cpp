@@ -12,6 +12,7 @@
  *                                                                                                                    *
  **********************************************************************************************************************/
 
+#include <cstring>
 #include <phon/runtime/function.hpp>
 #include <phon/runtime/runtime.hpp>
 
@@ -93,19 +94,37 @@ Routine::Routine(Routine *parent, const String &name, std::vector<Handle<Class>>
 
 }
 
-Instruction Routine::add_integer_constant(intptr_t i)
+size_t Routine::ConstantIndex::NumberHash::operator()(uint64_t n) const
 {
-	return add_constant(integer_pool, i);
+	return meta::hash(n);
 }
 
-Instruction Routine::add_float_constant(double n)
+Routine::ConstantIndex &Routine::get_constant_index()
 {
-	return add_constant(float_pool, n);
+	if (!constant_index) {
+		constant_index = std::make_unique<ConstantIndex>();
+	}
+
+	return *constant_index;
+}
+
+uint32_t Routine::add_integer_constant(intptr_t i)
+{
+	return add_constant(integer_pool, get_constant_index().integers, uint64_t(i), i);
+}
+
+uint32_t Routine::add_float_constant(double n)
+{
+	uint64_t bits;
+	static_assert(sizeof(bits) == sizeof(n));
+	memcpy(&bits, &n, sizeof(n));
+
+	return add_constant(float_pool, get_constant_index().floats, bits, n);
 }
 
-Instruction Routine::add_string_constant(String s)
+uint32_t Routine::add_string_constant(String s)
 {
-	return add_constant(string_pool, std::move(s));
+	return add_constant(string_pool, get_constant_index().strings, s, s);
 }
 
 Instruction Routine::add_local(const String &name, int scope, int depth)
@@ -154,14 +173,32 @@ std::optional<Instruction> Routine::resolve_upvalue(const String &name, int scop
 	return std::optional<Instruction>();
 }
 
+void Routine::clear_body()
+{
+	code = Code();
+	float_pool.clear();
+	integer_pool.clear();
+	string_pool.clear();
+	routine_pool.clear();
+	locals.clear();
+	upvalues.clear();
+	drop_constant_index();
+}
+
 int Routine::local_count() const
 {
 	return int(locals.size());
 }
 
-Instruction Routine::add_routine(std::shared_ptr<Routine> r)
+uint32_t Routine::add_routine(std::shared_ptr<Routine> r)
 {
-	return add_constant(routine_pool, std::move(r));
+	// Each routine is compiled exactly once, so there is nothing to deduplicate.
+	if (unlikely(routine_pool.size() == (std::numeric_limits<uint32_t>::max)())) {
+		throw error("Maximum number of constants exceeded");
+	}
+	routine_pool.push_back(std::move(r));
+
+	return uint32_t(routine_pool.size() - 1);
 }
 
 Instruction Routine::add_upvalue(Instruction index, bool local)
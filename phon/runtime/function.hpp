@@ -23,10 +23,14 @@
 #include <phon/runtime/typed_object.hpp>
 #include <phon/runtime/variant_def.hpp>
 #include <phon/runtime/code.hpp>
+#include <phon/runtime/hashmap.hpp>
 #include <phon/utils/span.hpp>
 
 namespace phonometrica {
 
+class AstArena;
+struct RoutineDefinition;
+
 class Runtime;
 class Function;
 class Class;
@@ -135,13 +139,13 @@ public:
 
 	bool is_native() const override { return false; }
 
-	Instruction add_integer_constant(intptr_t i);
+	uint32_t add_integer_constant(intptr_t i);
 
-	Instruction add_float_constant(double n);
+	uint32_t add_float_constant(double n);
 
-	Instruction add_string_constant(String s);
+	uint32_t add_string_constant(String s);
 
-	Instruction add_routine(std::shared_ptr<Routine> r);
+	uint32_t add_routine(std::shared_ptr<Routine> r);
 
 	Instruction add_local(const String &name, int scope, int depth);
 
@@ -163,6 +167,9 @@ public:
 
 	bool sealed() const { return is_sealed; }
 
+	// True if the routine's body will be compiled when it is first called.
+	bool deferred() const { return definition != nullptr; }
+
 	int upvalue_count() const override { return int(upvalues.size()); }
 
 private:
@@ -174,33 +181,58 @@ private:
 	// Bytecode.
 	Code code;
 
-	void seal() { is_sealed = true; }
+	void seal() { is_sealed = true; drop_constant_index(); }
+
+	// Discard a partially compiled body.
+	void clear_body();
 
 	Instruction add_upvalue(Instruction index, bool local);
 
-	template<class T>
-	Instruction add_constant(std::vector<T> &vec, T value)
+	// Release the lookup tables used to deduplicate constants. This is called once the routine has been compiled.
+	void drop_constant_index() { constant_index.reset(); }
+
+	template<class T, class Map>
+	uint32_t add_constant(std::vector<T> &vec, Map &index, typename Map::key_type key, T value)
 	{
-		auto it = std::find(vec.begin(), vec.end(), value);
+		auto result = index.insert({ std::move(key), uint32_t(vec.size()) });
 
-		if (it == vec.end())
+		if (result.second)
 		{
-			if (unlikely(vec.size() == (std::numeric_limits<Instruction>::max)())) {
+			if (unlikely(vec.size() == (std::numeric_limits<uint32_t>::max)())) {
 				throw error("Maximum number of constants exceeded");
 			}
 			vec.push_back(std::move(value));
-			return Instruction(vec.size() - 1);
 		}
 
-		return Instruction(std::distance(vec.begin(), it));
+		return result.first->second;
 	}
 
+	// Maps constants to their position in the pools while the routine is being compiled, so that each new literal
+	// is deduplicated in constant time. Floats are keyed by their bit pattern, which keeps 0.0 and -0.0 apart.
+	struct ConstantIndex
+	{
+		// Scramble numeric keys: the low bits of floats' bit patterns are often all zero.
+		struct NumberHash
+		{
+			size_t operator()(uint64_t n) const;
+		};
+
+		Hashmap<uint64_t, uint32_t, NumberHash> integers;
+		Hashmap<uint64_t, uint32_t, NumberHash> floats;
+		Hashmap<String, uint32_t> strings;
+	};
+
+	ConstantIndex &get_constant_index();
+
 	// Constant pools.
 	std::vector<double> float_pool;
 	std::vector<intptr_t> integer_pool;
 	std::vector<String> string_pool;
 	std::vector<std::shared_ptr<Routine>> routine_pool;
 
+	// Only needed during compilation.
+	std::unique_ptr<ConstantIndex> constant_index;
+
 	// Local variables.
 	std::vector<Local> locals;
 
@@ -209,6 +241,10 @@ private:
 	// Enclosing routine (this is used to find upvalues).
 	Routine *parent = nullptr;
 
+	// Definition of a routine whose compilation is deferred, and the syntax tree that owns it.
+	RoutineDefinition *definition = nullptr;
+	std::shared_ptr<AstArena> tree;
+
 	// We define the signature once at runtime and seal the routine.
 	bool is_sealed = false;
 };
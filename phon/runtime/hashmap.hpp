@@ -44,7 +44,10 @@ using Hashmap = std::unordered_map<Key, T, Hash, KeyEqual>;
 #include <exception>
 #include <functional>
 #include <iterator>
+#include <limits>
+#include <new>
 #include <type_traits>
+#include <phon/utils/alloc.hpp>
 
 
 namespace phonometrica {
@@ -84,7 +87,12 @@ public:
 
 		iterator(Hashmap *map, size_type pos)
 		{
-			if (!map->empty())
+			if (map->empty())
+			{
+				// The slots of an empty map may have been allocated (e.g. by reserve()), but none of them is used.
+				pos = map->capacity();
+			}
+			else
 			{
 				while (pos < map->capacity() && !map->node(pos)->used()) {
 					++pos;
@@ -239,7 +247,7 @@ public:
 	}
 
 	Hashmap(const Hashmap &other) :
-			Hashmap((other.size() + 1) * LoadFactor / 100)
+			Hashmap(other.size() * 100 / LoadFactor + 1)
 	{
 		for (auto &value : other)
 		{
@@ -401,15 +409,23 @@ public:
 		for (size_type i = 0; i < capacity; ++i)
 		{
 			auto n = &dat[i];
-			if (n->used()) n->~Node();
+			if (n->used())
+			{
+				n->~Node();
+				n->clear();
+			}
 		}
 
 		m_size = 0;
 	}
 
+	// Make sure that the map can hold at least `requested` elements without rehashing.
 	void reserve(size_type requested)
 	{
-		requested = next_power2(requested);
+		if (requested > max_size()) {
+			throw std::bad_alloc();
+		}
+		requested = next_power2(requested * 100 / LoadFactor + 1);
 		if (requested > this->capacity())
 		{
 			rehash(requested);
@@ -448,6 +464,13 @@ public:
 		m_size--;
 	}
 
+	// Largest number of elements that can be reserved: the capacity is a power of 2 and the size of the storage in bytes
+	// must fit in an intptr_t.
+	static constexpr size_type max_size() noexcept
+	{
+		return (((std::numeric_limits<size_type>::max)() / size_type(sizeof(storage_type)) + 1) / 2 - 1) / 100 * LoadFactor;
+	}
+
 	float max_load_factor() const
 	{
 		return float(LoadFactor) / 100;
@@ -457,7 +480,7 @@ private:
 
 	storage_type *allocate(size_type count)
 	{
-		auto dat = new storage_type[count];
+		auto dat = reinterpret_cast<storage_type*>(utils::alloc(intptr_t(count * sizeof(storage_type)), utils::MemoryCategory::Tables));
 
 		for (size_type i = 0; i < count; ++i)
 		{
@@ -470,7 +493,7 @@ private:
 	void deallocate()
 	{
 		clear();
-		delete[] m_data;
+		utils::free(m_data, utils::MemoryCategory::Tables);
 	}
 
 	void ensure_capacity()
@@ -486,8 +509,9 @@ private:
 	{
 		auto old_data = reinterpret_cast<Node*>(m_data);
 		auto old_capacity = this->capacity();
-		set_capacity(new_capacity);
+		// Allocate first, so that the map is left untouched if the allocation fails.
 		m_data = allocate(new_capacity);
+		set_capacity(new_capacity);
 
 		for (size_type i = 0; i < old_capacity; ++i)
 		{
@@ -500,7 +524,7 @@ private:
 		}
 
 		// Values have already been moved, so we just need to delete the storage.
-		delete[] reinterpret_cast<storage_type*>(old_data);
+		utils::free(old_data, utils::MemoryCategory::Tables);
 	}
 
 	size_t &get_hash(size_type pos)
@@ -110,6 +110,14 @@ RegexIterator::RegexIterator(Variant v, bool ref_val) : Iterator(std::move(v), r
 	re = &raw_cast<Regex>(object.resolve());
 }
 
+RegexIterator::RegexIterator(Variant v, String subject) : Iterator(std::move(v), false)
+{
+	re = &raw_cast<Regex>(object.resolve());
+	scanner = std::make_unique<RegexScanner>(*re, std::move(subject));
+}
+
+RegexIterator::~RegexIterator() = default;
+
 Variant RegexIterator::get_key()
 {
 	return pos;
@@ -120,11 +128,24 @@ Variant RegexIterator::get_value()
 	if (ref_val) {
 		throw error("[Reference error] Cannot take a reference to a group in a regular expression.\nHint: take the second loop variable by value, not by reference");
 	}
+	if (scanner)
+	{
+		Variant result = make_handle<Match>(scanner->get_match());
+		scanner->find_next();
+		pos++;
+
+		return result;
+	}
+
 	return re->capture(pos++);
 }
 
 bool RegexIterator::at_end() const
 {
+	if (scanner) {
+		return !scanner->has_match();
+	}
+
 	return pos > re->count();
 }
 
@@ -158,4 +179,31 @@ bool FileIterator::at_end() const
 {
 	return file->at_end();
 }
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+RangeIterator::RangeIterator(Variant v, bool ref_val) : Iterator(std::move(v), ref_val)
+{
+	range = &raw_cast<Range>(object.resolve());
+}
+
+Variant RangeIterator::get_key()
+{
+	return pos;
+}
+
+Variant RangeIterator::get_value()
+{
+	if (ref_val) {
+		throw error("[Reference error] Cannot take a reference to a value in a range.\nHint: take the second loop variable by value, not by reference");
+	}
+
+	return (*range)[pos++];
+}
+
+bool RangeIterator::at_end() const
+{
+	return pos > range->size();
+}
 } // namespace phonometrica
\ No newline at end of file
@@ -15,8 +15,10 @@
 #ifndef PHONOMETRICA_ITERATOR_HPP
 #define PHONOMETRICA_ITERATOR_HPP
 
+#include <memory>
 #include <phon/runtime/list.hpp>
 #include <phon/runtime/table.hpp>
+#include <phon/runtime/range.hpp>
 
 namespace phonometrica {
 
@@ -105,12 +107,18 @@ private:
 
 //---------------------------------------------------------------------------------------------------------------------
 
+// A regex iterator has two modes: by default, it iterates over the groups of the last match. If it is constructed
+// with a subject, it scans the subject and returns a Match object for each successive match.
 class RegexIterator : public Iterator
 {
 public:
 
 	RegexIterator(Variant v, bool ref_val);
 
+	RegexIterator(Variant v, String subject);
+
+	~RegexIterator() override;
+
 	Variant get_key() override;
 
 	Variant get_value() override;
@@ -121,6 +129,7 @@ private:
 
 	Regex *re;
 	intptr_t pos = 1;
+	std::unique_ptr<RegexScanner> scanner;
 };
 
 
@@ -144,6 +153,27 @@ private:
 	intptr_t pos = 1;
 };
 
+
+//---------------------------------------------------------------------------------------------------------------------
+
+class RangeIterator : public Iterator
+{
+public:
+
+	RangeIterator(Variant v, bool ref_val);
+
+	Variant get_key() override;
+
+	Variant get_value() override;
+
+	bool at_end() const override;
+
+private:
+
+	Range *range;
+	intptr_t pos = 1;
+};
+
 } // namespace phonometrica
 
 #endif // PHONOMETRICA_ITERATOR_HPP
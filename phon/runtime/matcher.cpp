@@ -0,0 +1,275 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: see header.                                                                                               *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+
+#include <algorithm>
+#include <queue>
+#include <phon/runtime/matcher.hpp>
+#include <phon/error.hpp>
+#include <phon/third_party/utf8/utf8.h>
+#include <phon/third_party/utf8proc/utf8proc.h>
+
+namespace phonometrica {
+
+intptr_t detail::fold_codepoint(const char *s, intptr_t i, intptr_t size, char *buf, intptr_t &len)
+{
+	utf8proc_int32_t c;
+	auto n = utf8proc_iterate(reinterpret_cast<const utf8proc_uint8_t*>(s + i), size - i, &c);
+
+	if (n <= 0)
+	{
+		// Invalid UTF-8: pass the byte through unchanged.
+		buf[0] = s[i];
+		len = 1;
+		return 1;
+	}
+	len = utf8proc_encode_char(utf8proc_tolower(c), reinterpret_cast<utf8proc_uint8_t*>(buf));
+
+	return n;
+}
+
+Matcher::Matcher(const Array<String> &patterns, bool caseless) :
+	m_caseless(caseless)
+{
+	// Build the trie. Edges are kept sorted by label.
+	std::vector<std::vector<std::pair<uint8_t, int32_t>>> edges(1);
+	m_nodes.emplace_back();
+	m_patterns.reserve(size_t(patterns.size()));
+
+	for (auto &pattern : patterns)
+	{
+		if (pattern.empty()) {
+			throw error("[Runtime error] Cannot create a Matcher with an empty pattern");
+		}
+		auto index = int32_t(m_patterns.size());
+		m_patterns.push_back(pattern);
+		int32_t state = 0, length = 0;
+
+		auto add_byte = [&](uint8_t c) {
+			auto &e = edges[size_t(state)];
+			auto it = std::lower_bound(e.begin(), e.end(), c, [](auto &edge, uint8_t c) { return edge.first < c; });
+
+			if (it != e.end() && it->first == c)
+			{
+				state = it->second;
+			}
+			else
+			{
+				auto target = int32_t(m_nodes.size());
+				e.insert(it, { c, target });
+				m_nodes.emplace_back();
+				edges.emplace_back();
+				state = target;
+			}
+		};
+
+		auto s = pattern.data();
+		intptr_t size = pattern.size();
+
+		if (caseless)
+		{
+			char buf[8];
+			intptr_t i = 0, len;
+
+			while (i < size)
+			{
+				i += detail::fold_codepoint(s, i, size, buf, len);
+				for (intptr_t k = 0; k < len; k++) add_byte(uint8_t(buf[k]));
+				length++;
+			}
+		}
+		else
+		{
+			for (intptr_t i = 0; i < size; i++) add_byte(uint8_t(s[i]));
+			length = int32_t(size);
+		}
+
+		// If a pattern is repeated, the first occurrence wins.
+		auto &node = m_nodes[size_t(state)];
+		if (node.pattern < 0)
+		{
+			node.pattern = index;
+			node.length = length;
+			m_max_length = (std::max)(m_max_length, length);
+		}
+	}
+
+	build(edges);
+}
+
+void Matcher::build(std::vector<std::vector<std::pair<uint8_t, int32_t>>> &edges)
+{
+	// Flatten the edges.
+	for (size_t i = 0; i < m_nodes.size(); i++)
+	{
+		auto &node = m_nodes[i];
+		node.first_edge = int32_t(m_labels.size());
+		node.edge_count = int32_t(edges[i].size());
+
+		for (auto &e : edges[i])
+		{
+			m_labels.push_back(e.first);
+			m_targets.push_back(e.second);
+		}
+		if (node.pattern >= 0) {
+			node.output = int32_t(i);
+		}
+	}
+	edges.clear();
+
+	std::fill(std::begin(m_root), std::end(m_root), 0);
+	std::queue<int32_t> queue;
+	auto &root = m_nodes[0];
+
+	for (int32_t k = 0; k < root.edge_count; k++)
+	{
+		auto target = m_targets[size_t(root.first_edge + k)];
+		m_root[m_labels[size_t(root.first_edge + k)]] = target;
+		queue.push(target);
+	}
+
+	// Compute failure and output links in breadth-first order, so that the links of shallower nodes are known.
+	while (!queue.empty())
+	{
+		auto state = queue.front();
+		queue.pop();
+		auto &node = m_nodes[size_t(state)];
+
+		for (int32_t k = 0; k < node.edge_count; k++)
+		{
+			auto c = m_labels[size_t(node.first_edge + k)];
+			auto target = m_targets[size_t(node.first_edge + k)];
+			auto fail = next_state(node.fail, c);
+			auto &child = m_nodes[size_t(target)];
+			child.fail = fail;
+
+			if (child.output < 0) {
+				child.output = m_nodes[size_t(fail)].output;
+			}
+			queue.push(target);
+		}
+	}
+}
+
+int32_t Matcher::find_edge(int32_t state, uint8_t c) const
+{
+	auto &node = m_nodes[size_t(state)];
+	auto first = m_labels.begin() + node.first_edge;
+	auto last = first + node.edge_count;
+	auto it = std::lower_bound(first, last, c);
+
+	return (it != last && *it == c) ? m_targets[size_t(it - m_labels.begin())] : -1;
+}
+
+int32_t Matcher::next_state(int32_t state, uint8_t c) const
+{
+	while (state != 0)
+	{
+		auto target = find_edge(state, c);
+		if (target >= 0) return target;
+		state = m_nodes[size_t(state)].fail;
+	}
+
+	return m_root[c];
+}
+
+intptr_t Matcher::count(const String &text) const
+{
+	intptr_t n = 0;
+	scan(text, [&](intptr_t, intptr_t, intptr_t) { n++; });
+
+	return n;
+}
+
+bool Matcher::contains(const String &text) const
+{
+	// We don't need to select matches here: stop as soon as we reach a state where a pattern ends.
+	if (m_nodes.size() <= 1) {
+		return false;
+	}
+	auto s = text.data();
+	intptr_t size = text.size();
+	int32_t state = 0;
+
+	if (m_caseless)
+	{
+		char buf[8];
+		intptr_t i = 0, len;
+
+		while (i < size)
+		{
+			i += detail::fold_codepoint(s, i, size, buf, len);
+			for (intptr_t k = 0; k < len; k++) state = next_state(state, uint8_t(buf[k]));
+			if (m_nodes[size_t(state)].output >= 0) return true;
+		}
+	}
+	else
+	{
+		for (intptr_t i = 0; i < size; i++)
+		{
+			state = next_state(state, uint8_t(s[i]));
+			if (m_nodes[size_t(state)].output >= 0) return true;
+		}
+	}
+
+	return false;
+}
+
+String Matcher::replace(const String &text, const std::vector<String> &replacements) const
+{
+	String result;
+	intptr_t last = 0;
+	bool found = false;
+	auto s = text.data();
+
+	scan(text, [&](intptr_t start, intptr_t end, intptr_t index) {
+		if (!found) result.reserve(text.size());
+		found = true;
+		result.append(Substring(s + last, size_t(start - last)));
+		result.append(replacements[size_t(index)]);
+		last = end;
+	});
+
+	if (!found) {
+		return text;
+	}
+	result.append(Substring(s + last, size_t(text.size() - last)));
+
+	return result;
+}
+
+String Matcher::replace(const String &text, Substring replacement) const
+{
+	String result;
+	intptr_t last = 0;
+	bool found = false;
+	auto s = text.data();
+
+	scan(text, [&](intptr_t start, intptr_t end, intptr_t) {
+		if (!found) result.reserve(text.size());
+		found = true;
+		result.append(Substring(s + last, size_t(start - last)));
+		result.append(replacement);
+		last = end;
+	});
+
+	if (!found) {
+		return text;
+	}
+	result.append(Substring(s + last, size_t(text.size() - last)));
+
+	return result;
+}
+
+} // namespace phonometrica
@@ -0,0 +1,209 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: Multi-pattern string matching with an Aho-Corasick automaton.                                             *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+
+#ifndef PHONOMETRICA_MATCHER_HPP
+#define PHONOMETRICA_MATCHER_HPP
+
+#include <vector>
+#include <phon/string.hpp>
+
+namespace phonometrica {
+
+// A matcher finds occurrences of a (possibly large) set of literal patterns in a text in a single pass, using an
+// Aho-Corasick automaton. Matches are reported from left to right and don't overlap: when several patterns match
+// at the same position, the longest one wins. If the matcher is caseless, both the patterns and the text are
+// compared after lower-casing each code point.
+class Matcher final
+{
+public:
+
+	Matcher(const Array<String> &patterns, bool caseless = false);
+
+	Matcher(const Matcher &) = delete;
+
+	Matcher(Matcher &&) noexcept = default;
+
+	bool operator==(const Matcher &other) const { return this == &other; }
+
+	// Number of patterns.
+	intptr_t size() const { return intptr_t(m_patterns.size()); }
+
+	bool caseless() const { return m_caseless; }
+
+	// Get the i-th pattern (0-based).
+	const String &pattern(intptr_t i) const { return m_patterns[size_t(i)]; }
+
+	// Call callback(start, end, index) for each match, where start and end are byte offsets and index is the
+	// (0-based) index of the pattern which matched.
+	template<class Callback>
+	void scan(const String &text, Callback callback) const;
+
+	intptr_t count(const String &text) const;
+
+	bool contains(const String &text) const;
+
+	// Replace each match with replacements[index] (0-based), where index is the index of the matching pattern.
+	String replace(const String &text, const std::vector<String> &replacements) const;
+
+	// Replace each match with the same string.
+	String replace(const String &text, Substring replacement) const;
+
+private:
+
+	struct Node
+	{
+		// First edge in m_labels/m_targets (edges are sorted by label).
+		int32_t first_edge = 0;
+
+		int32_t edge_count = 0;
+
+		// Longest proper suffix which is also in the trie.
+		int32_t fail = 0;
+
+		// Nearest node on the suffix chain (including this node) where a pattern ends, or -1.
+		int32_t output = -1;
+
+		// Index of the pattern ending at this node, or -1.
+		int32_t pattern = -1;
+
+		// Length of the pattern in units: bytes, or code points for caseless matchers.
+		int32_t length = 0;
+	};
+
+	void build(std::vector<std::vector<std::pair<uint8_t, int32_t>>> &edges);
+
+	int32_t next_state(int32_t state, uint8_t c) const;
+
+	int32_t find_edge(int32_t state, uint8_t c) const;
+
+	std::vector<String> m_patterns;
+
+	std::vector<Node> m_nodes;
+
+	std::vector<uint8_t> m_labels;
+
+	std::vector<int32_t> m_targets;
+
+	// Transitions from the root, which is visited very often.
+	int32_t m_root[256];
+
+	int32_t m_max_length = 0;
+
+	bool m_caseless;
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+namespace detail {
+
+// Decode the code point at s[i], lower-case it and encode it into buf. Returns the number of bytes read from s.
+intptr_t fold_codepoint(const char *s, intptr_t i, intptr_t size, char *buf, intptr_t &len);
+
+} // namespace phonometrica::detail
+
+template<class Callback>
+void Matcher::scan(const String &text, Callback callback) const
+{
+	if (m_nodes.size() <= 1 || text.empty()) {
+		return;
+	}
+
+	// We process the text one unit at a time (a byte or a code point). For each unit position, we keep the longest
+	// match starting at that position in a ring buffer. A position is final once no future match can start there,
+	// at which point we report its match unless it overlaps with the previous match.
+	struct Candidate
+	{
+		int32_t length = 0;
+		int32_t pattern = -1;
+	};
+
+	const intptr_t ring_size = m_max_length + 2;
+	std::vector<Candidate> candidates(static_cast<size_t>(ring_size));
+	std::vector<intptr_t> offsets(m_caseless ? size_t(ring_size) : 0);
+	auto s = text.data();
+	const intptr_t size = text.size();
+	intptr_t unit = 0, next_allowed = 0, finalized = 0;
+	int32_t state = 0;
+
+	auto offset = [&](intptr_t u) { return m_caseless ? offsets[size_t(u % ring_size)] : u; };
+
+	auto finalize = [&](intptr_t limit) {
+		for (; finalized < limit; finalized++)
+		{
+			auto &c = candidates[size_t(finalized % ring_size)];
+
+			if (c.length && finalized >= next_allowed)
+			{
+				callback(offset(finalized), offset(finalized + c.length), intptr_t(c.pattern));
+				next_allowed = finalized + c.length;
+			}
+			c = Candidate();
+		}
+	};
+
+	auto record = [&]() {
+		// Make room in the ring buffer: positions before unit - m_max_length can't be the start of a match anymore.
+		finalize(unit - m_max_length);
+
+		for (auto n = m_nodes[size_t(state)].output; n >= 0; n = m_nodes[size_t(m_nodes[size_t(n)].fail)].output)
+		{
+			auto &node = m_nodes[size_t(n)];
+			auto &c = candidates[size_t((unit - node.length) % ring_size)];
+
+			if (node.length > c.length) {
+				c.length = node.length;
+				c.pattern = node.pattern;
+			}
+		}
+		finalize(unit + 1 - m_max_length);
+	};
+
+	if (m_caseless)
+	{
+		char buf[8];
+		intptr_t i = 0, len;
+		offsets[0] = 0;
+
+		while (i < size)
+		{
+			i += detail::fold_codepoint(s, i, size, buf, len);
+
+			for (intptr_t k = 0; k < len; k++) {
+				state = next_state(state, uint8_t(buf[k]));
+			}
+			unit++;
+			offsets[size_t(unit % ring_size)] = i;
+			record();
+		}
+	}
+	else
+	{
+		for (; unit < size;)
+		{
+			state = next_state(state, uint8_t(s[unit]));
+			unit++;
+			if (m_nodes[size_t(state)].output >= 0) {
+				record();
+			}
+		}
+	}
+
+	finalize(unit);
+}
+
+} // namespace phonometrica
+
+#endif // PHONOMETRICA_MATCHER_HPP
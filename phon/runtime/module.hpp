@@ -45,6 +45,8 @@ public:
 
 	void insert(value_type v) { members.insert(std::move(v)); }
 
+	void erase(const String &key) { members.erase(key); }
+
 	Variant &get(const String &key);
 
 private:
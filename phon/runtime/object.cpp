@@ -24,6 +24,28 @@ Object::Object(Class *klass, bool collectable) :
 
 }
 
+void *Object::allocate(Class *klass, size_t size)
+{
+	auto ptr = utils::alloc(intptr_t(size), utils::MemoryCategory::Objects);
+
+	// Class is null while we are bootstrapping the class system.
+	if (klass && utils::get_memory_tracker()) {
+		klass->memory.add(intptr_t(size));
+	}
+
+	return ptr;
+}
+
+void Object::deallocate(Class *klass, void *ptr, size_t size)
+{
+	// Only instances that were accounted for count against their class.
+	auto tracker = utils::get_memory_tracker();
+	if (klass && tracker && tracker->accounts_for(ptr)) {
+		klass->memory.remove(intptr_t(size));
+	}
+	utils::free(ptr, utils::MemoryCategory::Objects);
+}
+
 void Object::destroy()
 {
 	assert(klass->destroy);
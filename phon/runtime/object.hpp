@@ -133,6 +133,11 @@ protected:
 
 	void destroy();
 
+	// Objects are allocated through utils::alloc() so that they can be accounted for, both globally and by class.
+	static void *allocate(Class *klass, size_t size);
+
+	static void deallocate(Class *klass, void *ptr, size_t size);
+
 	bool is_black() const
 	{
 		return gc_color == GCColor::Black;
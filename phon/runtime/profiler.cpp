@@ -0,0 +1,272 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: Instrumentation for script code: sampling profiler and opcode statistics.                                 *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+
+#include <algorithm>
+#include <cstdio>
+#include <phon/runtime/profiler.hpp>
+#include <phon/utils/helpers.hpp>
+#include <phon/error.hpp>
+
+namespace phonometrica {
+
+Profiler::Profiler(int interval) : m_interval(interval)
+{
+	if (interval <= 0) {
+		throw error("[Runtime error] The sampling interval must be a positive number of instructions, got %", interval);
+	}
+}
+
+void Profiler::add_sample(const std::vector<Frame> &stack)
+{
+	if (stack.empty()) {
+		return;
+	}
+	m_samples++;
+
+	String collapsed;
+	std::vector<const String*> seen;
+
+	for (auto &frame : stack)
+	{
+		// Recursive functions are only counted once per sample.
+		auto it = std::find_if(seen.begin(), seen.end(), [&](const String *s) { return *s == frame.function; });
+
+		if (it == seen.end())
+		{
+			m_functions[frame.function].total++;
+			seen.push_back(&frame.function);
+		}
+		if (!collapsed.empty()) {
+			collapsed.append(';');
+		}
+		collapsed.append(frame.function);
+	}
+
+	auto &top = stack.back();
+	m_functions[top.function].self++;
+	m_lines[{top.function, top.line}]++;
+	m_stacks[collapsed]++;
+}
+
+String Profiler::report(int max_lines) const
+{
+	auto percent = [this](intptr_t n) { return m_samples ? 100.0 * double(n) / double(m_samples) : 0.0; };
+
+	std::vector<std::pair<String, FunctionStats>> functions(m_functions.begin(), m_functions.end());
+	std::stable_sort(functions.begin(), functions.end(), [](const auto &a, const auto &b) {
+		return a.second.self > b.second.self;
+	});
+
+	std::vector<std::pair<std::pair<String, int>, intptr_t>> lines(m_lines.begin(), m_lines.end());
+	std::stable_sort(lines.begin(), lines.end(), [](const auto &a, const auto &b) { return a.second > b.second; });
+
+	auto s = String::format("Profile: %ld samples (1 sample every %d instructions)\n\n", long(m_samples), m_interval);
+	s.append(String::format("%8s %8s   %s\n", "self", "total", "function"));
+
+	for (auto &f : functions) {
+		s.append(String::format("%7.1f%% %7.1f%%   %s\n", percent(f.second.self), percent(f.second.total), f.first.data()));
+	}
+
+	s.append(String::format("\n%8s %8s   %s\n", "hits", "line", "function"));
+	auto count = std::min<size_t>(lines.size(), size_t((std::max)(max_lines, 0)));
+
+	for (size_t i = 0; i < count; i++)
+	{
+		auto &ln = lines[i];
+		s.append(String::format("%8ld %8d   %s\n", long(ln.second), ln.first.second, ln.first.first.data()));
+	}
+
+	return s;
+}
+
+void Profiler::write_collapsed_stacks(const String &path) const
+{
+	// Don't use File here: flame graph tools don't expect a BOM.
+	auto handle = utils::open_file(path, "w");
+
+	if (handle == nullptr) {
+		throw error("[System error] Cannot open file \"%\"", path);
+	}
+
+	for (auto &stack : m_stacks) {
+		fprintf(handle, "%s %ld\n", stack.first.data(), long(stack.second));
+	}
+	fclose(handle);
+}
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+OpcodeStats::OpcodeStats() : m_pairs(OPCODE_COUNT * OPCODE_COUNT, 0)
+{
+	m_counts.fill(0);
+	m_times.fill(std::chrono::steady_clock::duration::zero());
+}
+
+intptr_t OpcodeStats::total() const
+{
+	intptr_t n = 0;
+	for (auto count : m_counts) n += count;
+
+	return n;
+}
+
+OpcodeStats::Category OpcodeStats::get_category(Opcode op)
+{
+	switch (op)
+	{
+		case Opcode::PushBoolean:
+		case Opcode::PushFalse:
+		case Opcode::PushFloat:
+		case Opcode::PushInteger:
+		case Opcode::PushNan:
+		case Opcode::PushNull:
+		case Opcode::PushSmallInt:
+		case Opcode::PushString:
+		case Opcode::PushTrue:
+		case Opcode::Wide:
+			return Category::Constant;
+		case Opcode::ClearLocal:
+		case Opcode::DecrementLocal:
+		case Opcode::DefineGlobal:
+		case Opcode::DefineLocal:
+		case Opcode::GetGlobal:
+		case Opcode::GetGlobalArg:
+		case Opcode::GetGlobalRef:
+		case Opcode::GetLocal:
+		case Opcode::GetLocalArg:
+		case Opcode::GetLocalRef:
+		case Opcode::GetUniqueGlobal:
+		case Opcode::GetUniqueLocal:
+		case Opcode::GetUniqueUpvalue:
+		case Opcode::GetUpvalue:
+		case Opcode::GetUpvalueArg:
+		case Opcode::GetUpvalueRef:
+		case Opcode::IncrementLocal:
+		case Opcode::SetGlobal:
+		case Opcode::SetLocal:
+		case Opcode::SetUpvalue:
+			return Category::Variable;
+		case Opcode::GetField:
+		case Opcode::GetFieldArg:
+		case Opcode::GetFieldRef:
+		case Opcode::GetIndex:
+		case Opcode::GetIndexArg:
+		case Opcode::GetIndexRef:
+		case Opcode::SetField:
+		case Opcode::SetIndex:
+			return Category::Indexing;
+		case Opcode::Add:
+		case Opcode::Concat:
+		case Opcode::Divide:
+		case Opcode::Modulus:
+		case Opcode::Multiply:
+		case Opcode::Negate:
+		case Opcode::Power:
+		case Opcode::Subtract:
+			return Category::Arithmetic;
+		case Opcode::Compare:
+		case Opcode::Equal:
+		case Opcode::Greater:
+		case Opcode::GreaterEqual:
+		case Opcode::Less:
+		case Opcode::LessEqual:
+		case Opcode::Not:
+		case Opcode::NotEqual:
+			return Category::Comparison;
+		case Opcode::Call:
+		case Opcode::Jump:
+		case Opcode::JumpFalse:
+		case Opcode::JumpTrue:
+		case Opcode::NewFrame:
+		case Opcode::Precall:
+		case Opcode::Return:
+			return Category::Control;
+		case Opcode::NewArray:
+		case Opcode::NewClosure:
+		case Opcode::NewIterator:
+		case Opcode::NewList:
+		case Opcode::NewSet:
+		case Opcode::NewTable:
+			return Category::Construction;
+		case Opcode::NextKey:
+		case Opcode::NextValue:
+		case Opcode::TestIterator:
+			return Category::Iteration;
+		default:
+			return Category::Other;
+	}
+}
+
+const char *OpcodeStats::get_category_name(Category c)
+{
+	static const char *names[] = {
+		"constant", "variable", "indexing", "arithmetic", "comparison", "control", "construction", "iteration", "other"
+	};
+	static_assert(sizeof(names) / sizeof(names[0]) == CategoryCount);
+
+	return names[size_t(c)];
+}
+
+String OpcodeStats::report(int max_pairs) const
+{
+	auto n = total();
+	auto percent = [n](intptr_t count) { return n ? 100.0 * double(count) / double(n) : 0.0; };
+
+	std::vector<size_t> ops;
+	for (size_t i = 0; i < OPCODE_COUNT; i++) {
+		if (m_counts[i]) ops.push_back(i);
+	}
+	std::stable_sort(ops.begin(), ops.end(), [this](size_t a, size_t b) { return m_counts[a] > m_counts[b]; });
+
+	std::vector<size_t> pairs;
+	for (size_t i = 0; i < m_pairs.size(); i++) {
+		if (m_pairs[i]) pairs.push_back(i);
+	}
+	std::stable_sort(pairs.begin(), pairs.end(), [this](size_t a, size_t b) { return m_pairs[a] > m_pairs[b]; });
+
+	auto s = String::format("Opcode statistics: %ld instructions executed\n\n", long(n));
+	s.append(String::format("%12s %7s   %s\n", "count", "", "opcode"));
+
+	for (auto i : ops) {
+		s.append(String::format("%12ld %6.2f%%   %s\n", long(m_counts[i]), percent(m_counts[i]), Code::get_opcode_name(Instruction(i))));
+	}
+
+	s.append(String::format("\n%12s %7s   %s\n", "count", "", "opcode pair"));
+	auto count = std::min<size_t>(pairs.size(), size_t((std::max)(max_pairs, 0)));
+
+	for (size_t k = 0; k < count; k++)
+	{
+		auto i = pairs[k];
+		auto first = Code::get_opcode_name(Instruction(i / OPCODE_COUNT));
+		auto second = Code::get_opcode_name(Instruction(i % OPCODE_COUNT));
+		s.append(String::format("%12ld %6.2f%%   %s -> %s\n", long(m_pairs[i]), percent(m_pairs[i]), first, second));
+	}
+
+	using ms = std::chrono::duration<double, std::milli>;
+	std::chrono::steady_clock::duration total_time{};
+	for (auto t : m_times) total_time += t;
+	s.append(String::format("\n%12s %7s   %s\n", "time (ms)", "", "category"));
+
+	for (size_t c = 0; c < CategoryCount; c++)
+	{
+		double share = total_time.count() ? 100.0 * double(m_times[c].count()) / double(total_time.count()) : 0.0;
+		s.append(String::format("%12.3f %6.2f%%   %s\n", ms(m_times[c]).count(), share, get_category_name(Category(c))));
+	}
+
+	return s;
+}
+
+} // namespace phonometrica
@@ -0,0 +1,156 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: Instrumentation for script code: sampling profiler and opcode statistics.                                 *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+
+#ifndef PHONOMETRICA_PROFILER_HPP
+#define PHONOMETRICA_PROFILER_HPP
+
+#include <array>
+#include <chrono>
+#include <map>
+#include <utility>
+#include <vector>
+#include <phon/string.hpp>
+#include <phon/runtime/code.hpp>
+
+namespace phonometrica {
+
+// The profiler aggregates samples of the script call stack. The runtime takes a sample every `interval` instructions,
+// so the counts are proportional to the number of instructions executed in each function and on each line. Time spent
+// in native functions is not sampled.
+class Profiler final
+{
+public:
+
+	// A call frame in a sample: the function's label and the line being executed in that function.
+	struct Frame
+	{
+		String function;
+		int line;
+	};
+
+	static constexpr int DefaultInterval = 1000;
+
+	explicit Profiler(int interval = DefaultInterval);
+
+	int interval() const { return m_interval; }
+
+	intptr_t sample_count() const { return m_samples; }
+
+	// Record a call stack, from the outermost frame to the innermost one.
+	void add_sample(const std::vector<Frame> &stack);
+
+	// Per-function self/total counts and the hottest lines, as a human-readable table.
+	String report(int max_lines = 25) const;
+
+	// Write one line per distinct call stack ("main;f;g count"), in the format used by flame graph tools.
+	void write_collapsed_stacks(const String &path) const;
+
+private:
+
+	struct FunctionStats
+	{
+		// Samples in which the function was executing.
+		intptr_t self = 0;
+
+		// Samples in which the function was on the stack.
+		intptr_t total = 0;
+	};
+
+	std::map<String, FunctionStats> m_functions;
+
+	// Hit counts per (function, line).
+	std::map<std::pair<String, int>, intptr_t> m_lines;
+
+	// Hit counts per collapsed stack.
+	std::map<String, intptr_t> m_stacks;
+
+	intptr_t m_samples = 0;
+
+	int m_interval;
+};
+
+
+//----------------------------------------------------------------------------------------------------------------------
+
+// Opcode statistics count how many times each opcode and each pair of consecutive opcodes are executed, and measure
+// the time spent in each category of opcodes. The time of an instruction runs until the next instruction is
+// dispatched, so it includes the native functions and the calls it triggers up to the callee's first instruction.
+class OpcodeStats final
+{
+public:
+
+	enum class Category : uint8_t
+	{
+		Constant,		// Push constants and literals
+		Variable,		// Access locals, globals and upvalues
+		Indexing,		// Access fields and indexed elements
+		Arithmetic,
+		Comparison,
+		Control,		// Jumps, calls and returns
+		Construction,	// Create containers, closures and iterators
+		Iteration,
+		Other
+	};
+
+	static constexpr size_t CategoryCount = size_t(Category::Other) + 1;
+
+	OpcodeStats();
+
+	void record(Opcode op)
+	{
+		auto now = std::chrono::steady_clock::now();
+		auto i = static_cast<size_t>(op);
+
+		if (m_previous < OPCODE_COUNT)
+		{
+			m_pairs[m_previous * OPCODE_COUNT + i]++;
+			m_times[size_t(get_category(Opcode(m_previous)))] += now - m_last;
+		}
+		m_counts[i]++;
+		m_previous = i;
+		m_last = now;
+	}
+
+	intptr_t count(Opcode op) const { return m_counts[size_t(op)]; }
+
+	intptr_t count(Opcode first, Opcode second) const { return m_pairs[size_t(first) * OPCODE_COUNT + size_t(second)]; }
+
+	intptr_t total() const;
+
+	static Category get_category(Opcode op);
+
+	static const char *get_category_name(Category c);
+
+	// Opcode counts, the most frequent pairs and the time per category, as a human-readable table.
+	String report(int max_pairs = 25) const;
+
+private:
+
+	std::array<intptr_t, OPCODE_COUNT> m_counts;
+
+	// Pair counts, indexed by first * OPCODE_COUNT + second.
+	std::vector<intptr_t> m_pairs;
+
+	std::array<std::chrono::steady_clock::duration, CategoryCount> m_times;
+
+	// Previous opcode (OPCODE_COUNT if there is none) and the time at which it was dispatched.
+	size_t m_previous = OPCODE_COUNT;
+
+	std::chrono::steady_clock::time_point m_last;
+};
+
+} // namespace phonometrica
+
+#endif // PHONOMETRICA_PROFILER_HPP
@@ -0,0 +1,109 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: see header.                                                                                               *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include <limits>
+#include <phon/runtime/range.hpp>
+
+namespace phonometrica {
+
+// Absolute value of the step. This is computed in unsigned arithmetic so that it is valid for the smallest integer.
+static uintptr_t get_step_magnitude(intptr_t step)
+{
+	return (step > 0) ? uintptr_t(step) : uintptr_t(0) - uintptr_t(step);
+}
+
+Range::Range(intptr_t start, intptr_t stop, intptr_t step) :
+	m_start(start), m_stop(stop), m_step(step)
+{
+	if (step == 0) {
+		throw error("[Math error] Range step cannot be 0");
+	}
+
+	if ((step > 0 && stop < start) || (step < 0 && stop > start)) {
+		m_size = 0;
+	}
+	else
+	{
+		// The distance between start and stop may not fit in intptr_t, but it always fits in uintptr_t.
+		auto span = (step > 0) ? uintptr_t(stop) - uintptr_t(start) : uintptr_t(start) - uintptr_t(stop);
+		auto count = span / get_step_magnitude(step);
+
+		if (count >= uintptr_t(std::numeric_limits<intptr_t>::max())) {
+			throw error("[Math error] Range from % to % with step % has too many elements", start, stop, step);
+		}
+		m_size = intptr_t(count) + 1;
+	}
+}
+
+bool Range::operator==(const Range &other) const
+{
+	// Ranges are equal if they generate the same values.
+	if (m_size != other.m_size) return false;
+	if (m_size == 0) return true;
+	return m_start == other.m_start && (m_size == 1 || m_step == other.m_step);
+}
+
+intptr_t Range::at(intptr_t i) const
+{
+	auto pos = (i < 0) ? i + m_size + 1 : i;
+
+	if (pos <= 0 || pos > m_size) {
+		throw error("[Index error] Index % out of range in range with % elements", i, m_size);
+	}
+
+	return (*this)[pos];
+}
+
+bool Range::contains(intptr_t value) const
+{
+	if (m_size == 0) return false;
+	uintptr_t offset;
+
+	if (m_step > 0)
+	{
+		if (value < m_start) return false;
+		offset = uintptr_t(value) - uintptr_t(m_start);
+	}
+	else
+	{
+		if (value > m_start) return false;
+		offset = uintptr_t(m_start) - uintptr_t(value);
+	}
+	auto step = get_step_magnitude(m_step);
+	if (offset % step != 0) return false;
+
+	return offset / step < uintptr_t(m_size);
+}
+
+List::Storage Range::to_list() const
+{
+	List::Storage result(m_size);
+
+	for (intptr_t i = 1; i <= m_size; i++) {
+		result.append((*this)[i]);
+	}
+
+	return result;
+}
+
+String Range::to_string() const
+{
+	if (m_step == 1) {
+		return String::format("range(%lld, %lld)", (long long) m_start, (long long) m_stop);
+	}
+
+	return String::format("range(%lld, %lld, %lld)", (long long) m_start, (long long) m_stop, (long long) m_step);
+}
+
+} // namespace phonometrica
@@ -0,0 +1,77 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: Range type: a lazy sequence of integers which is only materialized on request.                            *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef PHONOMETRICA_RANGE_HPP
+#define PHONOMETRICA_RANGE_HPP
+
+#include <phon/runtime/list.hpp>
+
+namespace phonometrica {
+
+// A range represents the integers from start to stop (inclusive), by increments of step, like a numeric for loop.
+// Values are computed on the fly, so that a range uses a constant amount of memory regardless of its size.
+class Range final
+{
+public:
+
+	Range(intptr_t start, intptr_t stop, intptr_t step = 1);
+
+	Range(const Range &) = default;
+
+	bool operator==(const Range &other) const;
+
+	intptr_t start() const { return m_start; }
+
+	intptr_t stop() const { return m_stop; }
+
+	intptr_t step() const { return m_step; }
+
+	intptr_t size() const { return m_size; }
+
+	bool empty() const { return m_size == 0; }
+
+	// Get the i-th value. Accepts a positive (1-based) or negative index. Bounds are checked.
+	intptr_t at(intptr_t i) const;
+
+	// Get the i-th value. Only accepts a positive (1-based) index. No bound checking is performed.
+	// The offset from the start may overflow intptr_t even though the result doesn't, so compute it in unsigned arithmetic.
+	intptr_t operator[](intptr_t i) const { return intptr_t(uintptr_t(m_start) + uintptr_t(i - 1) * uintptr_t(m_step)); }
+
+	bool contains(intptr_t value) const;
+
+	// Create the list of all the values in the range.
+	List::Storage to_list() const;
+
+	String to_string() const;
+
+private:
+
+	intptr_t m_start, m_stop, m_step, m_size;
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+namespace meta {
+
+static inline String to_string(const Range &range)
+{
+	return range.to_string();
+}
+
+} // namespace phonometrica::meta
+
+} // namespace phonometrica
+
+#endif // PHONOMETRICA_RANGE_HPP
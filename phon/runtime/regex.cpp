@@ -12,6 +12,10 @@
  *                                                                                                                    *
  **********************************************************************************************************************/
 
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <unordered_map>
 #include <phon/regex.hpp>
 #include <phon/error.hpp>
 #include <phon/third_party/utf8/utf8.h>
@@ -21,6 +25,116 @@ namespace phonometrica {
 static const uint32_t OVECCOUNT = 30;
 static const size_t ERROR_BUFFER_SIZE = 512;
 
+struct Regex::Code
+{
+	Code(pcre2_code *code, Jit jit) : code(code), jit(jit) { }
+
+	Code(const Code &) = delete;
+
+	~Code() { pcre2_code_free(code); }
+
+	pcre2_code *code;
+
+	// JIT mode, or NoJit if JIT compilation failed.
+	Jit jit;
+};
+
+namespace {
+
+struct RegexCache
+{
+	using Entry = std::pair<String, std::shared_ptr<Regex::Code>>;
+
+	std::mutex mutex;
+
+	// Most recently used entries first.
+	std::list<Entry> entries;
+
+	std::unordered_map<String, std::list<Entry>::iterator> index;
+
+	intptr_t capacity = 256;
+
+	intptr_t hits = 0, misses = 0;
+
+	void trim()
+	{
+		while (intptr_t(entries.size()) > capacity)
+		{
+			index.erase(entries.back().first);
+			entries.pop_back();
+		}
+	}
+};
+
+RegexCache &regex_cache()
+{
+	static RegexCache cache;
+	return cache;
+}
+
+// Size of the JIT stack requested with set_jit_stack_size(), or 0 for PCRE2's default.
+std::atomic<size_t> jit_stack_size { 0 };
+
+// A JIT stack must not be used by two threads at the same time, so each thread has its own. It is only (re)allocated by
+// its thread, between two matches: matching never runs script code, so a stack can't be replaced while it is in use.
+struct JitStack
+{
+	~JitStack() { reset(); }
+
+	void reset()
+	{
+		if (context) pcre2_match_context_free(context);
+		if (stack) pcre2_jit_stack_free(stack);
+		context = nullptr;
+		stack = nullptr;
+		size = 0;
+	}
+
+	void resize(size_t value)
+	{
+		reset();
+
+		if (value > 0)
+		{
+			stack = pcre2_jit_stack_create((std::min<size_t>)(32 * 1024, value), value, nullptr);
+			context = pcre2_match_context_create(nullptr);
+
+			if (!stack || !context)
+			{
+				reset();
+				throw error("[Regex error] Could not allocate JIT stack");
+			}
+			pcre2_jit_stack_assign(context, nullptr, stack);
+			size = value;
+		}
+	}
+
+	pcre2_jit_stack *stack = nullptr;
+	pcre2_match_context *context = nullptr;
+	size_t size = 0;
+};
+
+JitStack &jit_stack()
+{
+	static thread_local JitStack js;
+	return js;
+}
+
+// Match context to use for matching. This is null unless a JIT stack size was set.
+inline pcre2_match_context *match_context()
+{
+	auto &js = jit_stack();
+	auto size = jit_stack_size.load(std::memory_order_relaxed);
+
+	if (unlikely(js.size != size)) {
+		js.resize(size);
+	}
+
+	return js.context;
+}
+
+} // namespace
+
 
 Regex::Regex(const String &pattern) :
     Regex(pattern, None)
@@ -31,15 +145,53 @@ Regex::Regex(const String &pattern) :
 Regex::Regex(const String &pattern, int flags, Regex::Jit jit) :
     m_pattern(pattern), m_flags(flags), m_jit(jit)
 {
-	m_regex = pcre2_compile((PCRE2_SPTR) pattern.data(), pattern.size(),
-	                        (uint32_t) flags|PCRE2_UTF, &m_error_code, &m_error_offset, nullptr);
+	auto &cache = regex_cache();
+	auto key = String::format("%d:%d:", flags, int(jit));
+	key.append(pattern);
+
+	{
+		std::lock_guard<std::mutex> lock(cache.mutex);
+		auto it = cache.index.find(key);
+
+		if (it != cache.index.end())
+		{
+			cache.entries.splice(cache.entries.begin(), cache.entries, it->second);
+			m_code = it->second->second;
+			cache.hits++;
+		}
+		else
+		{
+			cache.misses++;
+		}
+	}
 
-	if (m_regex == nullptr) {
-		throw error("compilation of regular expression failed at position %: %",
-		            m_error_offset + 1, error_message(m_error_code));
+	if (!m_code)
+	{
+		auto code = pcre2_compile((PCRE2_SPTR) pattern.data(), pattern.size(),
+		                          (uint32_t) flags|PCRE2_UTF, &m_error_code, &m_error_offset, nullptr);
+
+		if (code == nullptr) {
+			throw error("compilation of regular expression failed at position %: %",
+			            m_error_offset + 1, error_message(m_error_code));
+		}
+
+		m_code = std::make_shared<Code>(code, jit);
+		m_regex = code;
+		this->jit(jit);
+		m_code->jit = m_jit;
+
+		std::lock_guard<std::mutex> lock(cache.mutex);
+
+		if (cache.capacity > 0 && cache.index.find(key) == cache.index.end())
+		{
+			cache.entries.emplace_front(std::move(key), m_code);
+			cache.index[cache.entries.front().first] = cache.entries.begin();
+			cache.trim();
+		}
 	}
 
-	this->jit(jit);
+	m_regex = m_code->code;
+	m_jit = m_code->jit;
 	m_match_data = pcre2_match_data_create(OVECCOUNT, nullptr);
 }
 
@@ -58,7 +210,7 @@ String Regex::error_message(int error)
 }
 
 Regex::Regex(Regex &&other) noexcept :
-		m_subject(std::move(other.m_subject)), m_pattern(std::move(other.m_pattern))
+		m_code(std::move(other.m_code)), m_subject(std::move(other.m_subject)), m_pattern(std::move(other.m_pattern))
 {
 	m_regex = other.m_regex;
 	m_match_data = other.m_match_data;
@@ -77,10 +229,6 @@ Regex::~Regex()
 	if (m_match_data) {
 		pcre2_match_data_free(m_match_data);
 	}
-
-	if (m_regex) {
-		pcre2_code_free(m_regex);
-	}
 }
 
 String Regex::subject() const
@@ -111,10 +259,10 @@ bool Regex::match(const String &subject, String::const_iterator from)
 	size_t index = from - subject.begin();
 
 	if (m_jit == NoJit) {
-		m_rc = pcre2_match(m_regex, (PCRE2_SPTR) subject.data(), subject.size(), index, 0, m_match_data, nullptr);
+		m_rc = pcre2_match(m_regex, (PCRE2_SPTR) subject.data(), subject.size(), index, 0, m_match_data, match_context());
 	}
 	else {
-		m_rc = pcre2_jit_match(m_regex, (PCRE2_SPTR) subject.data(), subject.size(), index, 0, m_match_data, nullptr);
+		m_rc = pcre2_jit_match(m_regex, (PCRE2_SPTR) subject.data(), subject.size(), index, 0, m_match_data, match_context());
 	}
 
 	// -1 is used to indicate there is no match, so we don't want to trigger an error for that
@@ -258,4 +406,294 @@ bool Regex::jit(Regex::Jit flag)
 	return ok;
 }
 
+int Regex::match_at(const String &subject, size_t offset, uint32_t options, pcre2_match_data *data) const
+{
+	int rc;
+
+	if (m_jit == NoJit) {
+		rc = pcre2_match(m_regex, (PCRE2_SPTR) subject.data(), subject.size(), offset, options, data, match_context());
+	}
+	else {
+		rc = pcre2_jit_match(m_regex, (PCRE2_SPTR) subject.data(), subject.size(), offset, options, data, match_context());
+	}
+
+	if (rc < -1) {
+		throw error(const_cast<Regex*>(this)->error_message(rc));
+	}
+
+	return (std::max)(rc, 0);
+}
+
+Regex::CacheStats Regex::cache_stats()
+{
+	auto &cache = regex_cache();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+
+	return { intptr_t(cache.entries.size()), cache.capacity, cache.hits, cache.misses };
+}
+
+void Regex::set_cache_capacity(intptr_t value)
+{
+	auto &cache = regex_cache();
+	std::lock_guard<std::mutex> lock(cache.mutex);
+	cache.capacity = (std::max<intptr_t>)(value, 0);
+	cache.trim();
+}
+
+void Regex::set_jit_stack_size(size_t value)
+{
+	// Allocate the stack of the calling thread right away so that an allocation failure is reported here. Other
+	// threads pick up the new size before their next match.
+	jit_stack().resize(value);
+	jit_stack_size.store(value, std::memory_order_relaxed);
+}
+
+pcre2_match_data *Regex::create_match_data() const
+{
+	return pcre2_match_data_create_from_pattern(m_regex, nullptr);
+}
+
+
+String Regex::replace(const String &subject, Substring replacement, intptr_t ntimes) const
+{
+	// A segment is either a literal (group < 0) or a reference to a group.
+	struct Segment
+	{
+		intptr_t group;
+		Substring text;
+	};
+	std::vector<Segment> segments;
+	size_t literal_start = 0;
+	uint32_t group_count = 0;
+	pcre2_pattern_info(m_regex, PCRE2_INFO_CAPTURECOUNT, &group_count);
+
+	auto add_literal = [&](size_t end) {
+		if (end > literal_start) {
+			segments.push_back({ -1, replacement.substr(literal_start, end - literal_start) });
+		}
+	};
+
+	for (size_t i = 0; i + 1 < replacement.size(); i++)
+	{
+		if (replacement[i] != '%') continue;
+		auto c = replacement[i+1];
+		intptr_t group = -1;
+
+		if (c == '%') {
+			group = 0;
+		}
+		else if (c >= '1' && c <= '9' && uint32_t(c - '0') <= group_count) {
+			group = c - '0';
+		}
+
+		if (group >= 0)
+		{
+			add_literal(i);
+			segments.push_back({ group, Substring() });
+			literal_start = i + 2;
+			i++;
+		}
+	}
+	add_literal(replacement.size());
+
+	RegexScanner scanner(*this, subject);
+	String result;
+	size_t last = 0;
+	intptr_t n = 0;
+
+	if (scanner.has_match()) {
+		result.reserve(subject.size() + intptr_t(replacement.size()));
+	}
+
+	for (; scanner.has_match() && n != ntimes; n++)
+	{
+		auto ovector = scanner.offsets();
+		result.append(Substring(subject.data() + last, ovector[0] - last));
+
+		for (auto &seg : segments)
+		{
+			if (seg.group < 0)
+			{
+				result.append(seg.text);
+			}
+			else if (seg.group < scanner.count() && ovector[2 * seg.group] != PCRE2_UNSET)
+			{
+				auto from = ovector[2 * seg.group];
+				result.append(Substring(subject.data() + from, ovector[2 * seg.group + 1] - from));
+			}
+		}
+		last = ovector[1];
+		scanner.find_next();
+	}
+
+	if (n == 0) {
+		return subject;
+	}
+	result.append(Substring(subject.data() + last, size_t(subject.size()) - last));
+
+	return result;
+}
+
+Array<String> Regex::split(const String &subject) const
+{
+	RegexScanner scanner(*this, subject);
+	Array<String> strings;
+	size_t last = 0;
+
+	while (scanner.has_match())
+	{
+		auto ovector = scanner.offsets();
+		strings.append(String::fragment(subject.data() + last, intptr_t(ovector[0] - last)));
+		last = ovector[1];
+		scanner.find_next();
+	}
+	strings.append(subject.slice(subject.data() + last, subject.size() - intptr_t(last)));
+
+	return strings;
+}
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+Match::Match(String subject, const PCRE2_SIZE *ovector, int count, int size, intptr_t anchor_byte, intptr_t anchor_char) :
+	m_subject(std::move(subject)), m_offsets(2 * size, PCRE2_UNSET),
+	m_anchor_byte(anchor_byte), m_anchor_char(anchor_char)
+{
+	std::copy(ovector, ovector + 2 * count, m_offsets.begin());
+}
+
+bool Match::operator==(const Match &other) const
+{
+	return m_subject == other.m_subject && m_offsets == other.m_offsets;
+}
+
+void Match::check_group(intptr_t nth) const
+{
+	if (nth < 0 || nth > count()) {
+		throw error("[Index error] Invalid group index % (match has % groups)", nth, count());
+	}
+}
+
+String Match::group(intptr_t nth) const
+{
+	check_group(nth);
+	auto from = m_offsets[2 * nth];
+	auto to = m_offsets[2 * nth + 1];
+
+	if (from == PCRE2_UNSET) {
+		return String();
+	}
+
+	return String(m_subject.data() + from, intptr_t(to - from));
+}
+
+intptr_t Match::start(intptr_t nth) const
+{
+	check_group(nth);
+	auto offset = m_offsets[2 * nth];
+
+	return (offset == PCRE2_UNSET) ? 0 : byte_to_char(offset) + 1;
+}
+
+intptr_t Match::end(intptr_t nth) const
+{
+	check_group(nth);
+	auto offset = m_offsets[2 * nth + 1];
+
+	return (offset == PCRE2_UNSET) ? 0 : byte_to_char(offset) + 1;
+}
+
+RegexScanner::RegexScanner(const Regex &re, String subject) :
+	m_regex(re), m_subject(std::move(subject))
+{
+	m_match_data = re.create_match_data();
+	m_ascii = m_subject.is_ascii();
+	find_next();
+}
+
+RegexScanner::~RegexScanner()
+{
+	pcre2_match_data_free(m_match_data);
+}
+
+Match RegexScanner::get_match()
+{
+	auto ovector = pcre2_get_ovector_pointer(m_match_data);
+	auto start = intptr_t(ovector[0]);
+
+	// Move the anchor to the start of the current match, so that the cost of computing character positions is
+	// proportional to the distance between two successive matches.
+	if (m_ascii)
+	{
+		m_anchor_char = start;
+	}
+	else
+	{
+		auto s = reinterpret_cast<const unsigned char*>(m_subject.data());
+
+		for (; m_anchor_byte < start; m_anchor_byte++) {
+			m_anchor_char += ((s[m_anchor_byte] & 0xC0) != 0x80);
+		}
+		// With \K, a match may start before the previous one.
+		for (; m_anchor_byte > start; m_anchor_byte--) {
+			m_anchor_char -= ((s[m_anchor_byte - 1] & 0xC0) != 0x80);
+		}
+	}
+	m_anchor_byte = start;
+
+	return Match(m_subject, ovector, m_count, int(pcre2_get_ovector_count(m_match_data)), m_anchor_byte, m_anchor_char);
+}
+
+bool RegexScanner::find_next()
+{
+	const auto size = size_t(m_subject.size());
+	auto s = reinterpret_cast<const unsigned char*>(m_subject.data());
+
+	while (m_offset <= size)
+	{
+		uint32_t options = m_empty_match ? (PCRE2_NOTEMPTY_ATSTART | PCRE2_ANCHORED) : 0;
+		m_count = m_regex.match_at(m_subject, m_offset, options, m_match_data);
+
+		if (m_count > 0)
+		{
+			auto ovector = pcre2_get_ovector_pointer(m_match_data);
+			m_empty_match = (ovector[0] == ovector[1]);
+			m_offset = ovector[1];
+
+			return true;
+		}
+
+		if (!m_empty_match || m_offset == size) {
+			break;
+		}
+
+		// There is no non-empty match at the position of the last empty match: skip one code point and try again.
+		m_empty_match = false;
+		m_offset++;
+
+		while (m_offset < size && (s[m_offset] & 0xC0) == 0x80) {
+			m_offset++;
+		}
+	}
+
+	m_count = 0;
+	return false;
+}
+
+intptr_t Match::byte_to_char(size_t offset) const
+{
+	// Count the lead bytes between the anchor and the offset, which may be on either side of the anchor (e.g. with a
+	// lookbehind assertion).
+	auto s = reinterpret_cast<const unsigned char*>(m_subject.data());
+	intptr_t from = (std::min)(intptr_t(offset), m_anchor_byte);
+	intptr_t to = (std::max)(intptr_t(offset), m_anchor_byte);
+	intptr_t n = 0;
+
+	for (intptr_t i = from; i < to; i++) {
+		n += ((s[i] & 0xC0) != 0x80);
+	}
+
+	return (intptr_t(offset) < m_anchor_byte) ? m_anchor_char - n : m_anchor_char + n;
+}
+
 } // namespace phonometrica
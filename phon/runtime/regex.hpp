@@ -15,7 +15,10 @@
 #ifndef PHONOMETRICA_REGEX_HPP
 #define PHONOMETRICA_REGEX_HPP
 
+#include <memory>
+#include <vector>
 #include <phon/string.hpp>
+#include <phon/array.hpp>
 #include <pcre2.h>
 
 namespace phonometrica {
@@ -86,6 +89,39 @@ public:
 
 	bool jit(Jit flag);
 
+	// Low-level matching function used to scan a subject: match from a byte offset, storing the result in the provided
+	// match data. The state of the regex is not modified. Returns the number of groups + 1, or 0 if there is no match.
+	int match_at(const String &subject, size_t offset, uint32_t options, pcre2_match_data *data) const;
+
+	pcre2_match_data *create_match_data() const;
+
+	// Replace the first ntimes matches in the subject (all matches if ntimes is negative). In the replacement, "%%"
+	// stands for the whole match and "%1" to "%9" stand for groups. The replacement is parsed only once, and the result
+	// is built in a single buffer.
+	String replace(const String &subject, Substring replacement, intptr_t ntimes = -1) const;
+
+	// Split the subject at each match.
+	Array<String> split(const String &subject) const;
+
+	// Compiled patterns are shared through a process-wide LRU cache, keyed by pattern, flags and JIT mode.
+	struct CacheStats
+	{
+		intptr_t size, capacity, hits, misses;
+	};
+
+	static CacheStats cache_stats();
+
+	// Set the maximum number of compiled patterns kept in the cache. A capacity of 0 disables the cache.
+	static void set_cache_capacity(intptr_t value);
+
+	// Set the maximum size (in bytes) of the stack used by JIT-compiled patterns. By default, PCRE2 uses 32 KB on the
+	// machine stack, which may not be enough for complex patterns on long subjects. A size of 0 restores the default.
+	// Each thread gets a stack of its own with this size.
+	static void set_jit_stack_size(size_t value);
+
+	// Shared ownership of a compiled pattern.
+	struct Code;
+
 private:
 
     String error_message(int error);
@@ -94,6 +130,9 @@ private:
 
     int parse_flags(const String &options);
 
+	std::shared_ptr<Code> m_code;
+
+	// Borrowed from m_code.
 	pcre2_code *m_regex = nullptr;
 
 	pcre2_match_data *m_match_data = nullptr;
@@ -113,6 +152,112 @@ private:
 	Jit m_jit = Jit::NoJit;
 };
 
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// A match object holds a copy of the byte offsets of a match and its groups. Character positions are only computed
+// when they are requested, relative to an anchor (a byte offset whose code point index is known) which is close to
+// the match. This makes it possible to scan a long subject in linear time.
+class Match final
+{
+public:
+
+	// The ovector has room for `size` pairs, of which the first `count` were set by the last match.
+	Match(String subject, const PCRE2_SIZE *ovector, int count, int size, intptr_t anchor_byte, intptr_t anchor_char);
+
+	Match(const Match &) = default;
+
+	bool operator==(const Match &other) const;
+
+	// Number of groups, excluding the whole match.
+	intptr_t count() const { return intptr_t(m_offsets.size() / 2) - 1; }
+
+	String subject() const { return m_subject; }
+
+	// Get the text of a group. Group 0 is the whole match. A group that did not participate in the match is empty.
+	String group(intptr_t nth) const;
+
+	// 1-based code point indices of the beginning and end of a group, or 0 if it did not participate in the match.
+	intptr_t start(intptr_t nth) const;
+	intptr_t end(intptr_t nth) const;
+
+	String to_string() const { return group(0); }
+
+private:
+
+	void check_group(intptr_t nth) const;
+
+	intptr_t byte_to_char(size_t offset) const;
+
+	String m_subject;
+
+	std::vector<size_t> m_offsets;
+
+	intptr_t m_anchor_byte, m_anchor_char;
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+// Find all the non-overlapping matches of a regex in a subject, from left to right. The subject is scanned with byte
+// offsets, so that the whole scan is linear in the size of the subject. After an empty match, the scanner first
+// looks for a non-empty match at the same position and then moves forward by one code point.
+class RegexScanner final
+{
+public:
+
+	RegexScanner(const Regex &re, String subject);
+
+	RegexScanner(const RegexScanner &) = delete;
+
+	~RegexScanner();
+
+	bool has_match() const { return m_count > 0; }
+
+	// Get the current match. This must only be called if has_match() is true.
+	Match get_match();
+
+	// Move to the next match. Returns false if there are no more matches.
+	bool find_next();
+
+	// Byte offsets of the current match and its groups.
+	const PCRE2_SIZE *offsets() const { return pcre2_get_ovector_pointer(m_match_data); }
+
+	// Number of pairs set in offsets().
+	int count() const { return m_count; }
+
+private:
+
+	const Regex &m_regex;
+
+	String m_subject;
+
+	pcre2_match_data *m_match_data;
+
+	size_t m_offset = 0;
+
+	int m_count = 0;
+
+	bool m_empty_match = false;
+
+	bool m_ascii;
+
+	// Byte offset and code point index of the start of the last match returned by get_match().
+	intptr_t m_anchor_byte = 0, m_anchor_char = 0;
+};
+
+
+//---------------------------------------------------------------------------------------------------------------------
+
+namespace meta {
+
+static inline String to_string(const Match &m)
+{
+	return m.to_string();
+}
+
+} // namespace phonometrica::meta
+
 } // namespace phonometrica
 
 #endif // PHONOMETRICA_REGEX_HPP
@@ -17,12 +17,18 @@
 #include <ctime>
 #include <iomanip>
 #include <phon/runtime/runtime.hpp>
+#include <phon/utils/vector_math.hpp>
 #include <phon/regex.hpp>
+#include <phon/runtime/matcher.hpp>
 #include <phon/file.hpp>
 #include <phon/utils/helpers.hpp>
 
-#define CATCH_ERROR catch (std::runtime_error &e) { RUNTIME_ERROR(e.what()); }
+#define CATCH_ERROR catch (RuntimeError &) { throw; } catch (std::runtime_error &e) { RUNTIME_ERROR(e.what()); }
 #define RUNTIME_ERROR(...) throw RuntimeError(get_current_line(), __VA_ARGS__)
+// Count a checkpoint, and check the execution budget if needed.
+#define CHECKPOINT() if (unlikely(--budget_countdown <= 0)) check_budget()
+// Read an index into a constant pool, combining it with the high bits provided by a Wide prefix, if any.
+#define READ_CONSTANT() (uint32_t(*ip++) | std::exchange(wide_operand, 0))
 
 #if 0
 #	define trace_op() std::cerr << std::setw(6) << std::left << (ip-1-code->data()) << "\t" << std::setw(15) << Code::get_opcode_name(*(ip-1)) << "stack size = " << intptr_t(top - stack.data()) << std::endl;
@@ -53,12 +59,17 @@ Runtime::Runtime(intptr_t stack_size) :
 
 	create_builtins();
 	set_global_namespace();
+	for (auto &global : *globals) {
+		builtin_globals.insert(global.first);
+	}
 	this->top = this->stack.begin();
 	this->limit = this->stack.end();
 }
 
 phonometrica::Runtime::~Runtime()
 {
+	disable_memory_stats();
+
 	// Make sure we don't double free variants that have been destructed but are not null.
 	for (auto var = top; var < stack.end(); var++) {
 		new (var) Variant;
@@ -150,6 +161,8 @@ void Runtime::create_builtins()
 	auto float_class = create_type<double>("Float", num_class.get(), Class::Index::Float);
 	auto string_class = create_type<String>("String", raw_object_class, Class::Index::String);
 	auto regex_class = create_type<Regex>("Regex", raw_object_class, Class::Index::Regex);
+	auto match_class = create_type<Match>("Match", raw_object_class, Class::Index::Match);
+	auto matcher_class = create_type<Matcher>("Matcher", raw_object_class, Class::Index::Matcher);
 	auto list_class = create_type<List>("List", raw_object_class, Class::Index::List);
 	auto array_class = create_type<Array<double>>("Array", raw_object_class, Class::Index::Array);
 	auto table_class = create_type<Table>("Table", raw_object_class, Class::Index::Table);
@@ -159,6 +172,7 @@ void Runtime::create_builtins()
 	auto func_class = create_type<Function>("Function", raw_object_class, Class::Index::Function);
 	create_type<Closure>("Function", raw_object_class, Class::Index::Closure);
 	auto set_class = create_type<Set>("Set", raw_object_class, Class::Index::Set);
+	auto range_class = create_type<Range>("Range", raw_object_class, Class::Index::Range);
 
 	// Iterators are currently not exposed to users.
 	create_type<Iterator>("Iterator", raw_object_class, Class::Index::Iterator);
@@ -167,6 +181,7 @@ void Runtime::create_builtins()
 	create_type<StringIterator>("Iterator", raw_object_class, Class::Index::StringIterator);
 	create_type<FileIterator>("Iterator", raw_object_class, Class::Index::FileIterator);
 	create_type<RegexIterator>("Iterator", raw_object_class, Class::Index::RegexIterator);
+	create_type<RangeIterator>("Iterator", raw_object_class, Class::Index::RangeIterator);
 
 	// Sanity checks
 	assert(object_class.object()->get_class() != nullptr);
@@ -184,6 +199,8 @@ void Runtime::create_builtins()
 	GLOB(double, float_class);
 	GLOB(String, string_class);
 	GLOB(Regex, regex_class);
+	GLOB(Match, match_class);
+	GLOB(Matcher, matcher_class);
 	GLOB(List, list_class);
 	GLOB(Array<double>, array_class);
 	GLOB(Table, table_class);
@@ -191,6 +208,7 @@ void Runtime::create_builtins()
 	GLOB(Function, func_class);
 	GLOB(Module, module_class);
 	GLOB(Set, set_class);
+	GLOB(Range, range_class);
 #undef GLOB
 }
 
@@ -425,11 +443,60 @@ void Runtime::math_op(char op)
 		}
 	}
 
+	else if (op == '+' || op == '-' || op == '*' || op == '/')
+	{
+		bool is_array1 = check_type<Array<double>>(v1);
+		bool is_array2 = check_type<Array<double>>(v2);
+
+		if ((is_array1 && (is_array2 || v2.is_number())) || (is_array2 && v1.is_number()))
+		{
+			Variant result;
+			try {
+				result = array_math_op(op, v1, v2);
+			}
+			CATCH_ERROR
+			pop(2);
+			push(std::move(result));
+			return;
+		}
+	}
+
 	pop(2);
 	char opstring[2] = { op, '\0' };
 	RUNTIME_ERROR("[Type error] Cannot apply math operator '%' to % and %", opstring, v1.class_name(), v2.class_name());
 }
 
+Variant Runtime::array_math_op(char op, const Variant &v1, const Variant &v2)
+{
+	std::feclearexcept(FE_ALL_EXCEPT);
+	Array<double> result;
+
+	// The result is a copy of the array operand (so that it has the same shape), which is updated in place.
+	if (!check_type<Array<double>>(v1))
+	{
+		result = raw_cast<Array<double>>(v2);
+		utils::vector_op(op, v1.get_number(), result.data(), result.data(), result.size());
+	}
+	else if (!check_type<Array<double>>(v2))
+	{
+		result = raw_cast<Array<double>>(v1);
+		utils::vector_op(op, result.data(), v2.get_number(), result.data(), result.size());
+	}
+	else
+	{
+		auto &x = raw_cast<Array<double>>(v1);
+		auto &y = raw_cast<Array<double>>(v2);
+		if (x.ndim() != y.ndim() || x.nrow() != y.nrow() || x.ncol() != y.ncol()) {
+			throw error("[Index error] Cannot apply math operator to arrays with different shapes");
+		}
+		result = x;
+		utils::vector_op(op, result.data(), y.data(), result.data(), result.size());
+	}
+	check_float_error();
+
+	return make_handle<Array<double>>(std::move(result));
+}
+
 void Runtime::check_float_error()
 {
 	if (fetestexcept(FE_OVERFLOW | FE_UNDERFLOW | FE_DIVBYZERO | FE_INVALID))
@@ -451,6 +518,9 @@ void Runtime::check_float_error()
 
 Variant Runtime::interpret(Handle <Closure> &closure)
 {
+	if (unlikely(reinterpret_cast<Routine*>(closure->routine.get())->deferred())) {
+		compiler.compile_deferred(std::static_pointer_cast<Routine>(closure->routine));
+	}
 	if (current_frame) {
 		current_frame->previous_routine = current_routine;
 	}
@@ -459,11 +529,16 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 	current_routine = &routine;
 	code = &routine.code;
 	ip = routine.code.data();
+	uint32_t wide_operand = 0;
 
 	while (true)
 	{
 		auto op = static_cast<Opcode>(*ip++);
 
+		if (unlikely(instrumented)) {
+			instrument(op);
+		}
+
 		switch (op)
 		{
 			case Opcode::Add:
@@ -487,6 +562,7 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::Call:
 			{
 				trace_op();
+				CHECKPOINT();
 				Instruction flags = *ip++;
 				// TODO: handle return by reference
 				needs_ref = flags & (1<<9);
@@ -568,7 +644,7 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::DefineGlobal:
 			{
 				trace_op();
-				auto name = routine.get_string(*ip++);
+				auto name = routine.get_string(READ_CONSTANT());
 				if (globals->find(name) != globals->end())
 				{
 					RUNTIME_ERROR("Global variable \"%\" is already defined", name);
@@ -626,7 +702,7 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::GetGlobal:
 			{
 				trace_op();
-				auto name = routine.get_string(*ip++);
+				auto name = routine.get_string(READ_CONSTANT());
 				auto it = globals->find(name);
 				if (it == globals->end()) {
 					RUNTIME_ERROR("[Symbol error] Undefined variable \"%\"", name);
@@ -637,7 +713,7 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::GetGlobalArg:
 			{
 				trace_op();
-				auto name = routine.get_string(*ip++);
+				auto name = routine.get_string(READ_CONSTANT());
 				bool by_ref = current_frame->ref_flags[*ip++];
 				auto it = globals->find(name);
 				if (it == globals->end()) {
@@ -657,7 +733,7 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::GetGlobalRef:
 			{
 				trace_op();
-				auto name = routine.get_string(*ip++);
+				auto name = routine.get_string(READ_CONSTANT());
 				auto it = globals->find(name);
 				if (it == globals->end()) {
 					RUNTIME_ERROR("[Symbol error] Undefined variable \"%\"", name);
@@ -719,7 +795,7 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::GetUniqueGlobal:
 			{
 				trace_op();
-				auto name = routine.get_string(*ip++);
+				auto name = routine.get_string(READ_CONSTANT());
 				auto it = globals->find(name);
 				if (it == globals->end()) {
 					RUNTIME_ERROR("[Symbol error] Undefined variable \"%\"", name);
@@ -798,17 +874,26 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::Jump:
 			{
 				trace_op();
-				int addr = Code::read_integer(ip);
-				ip = code->data() + addr;
+				auto target = code->data() + Code::read_integer(ip);
+				if (target < ip) {
+					CHECKPOINT();
+				}
+				ip = target;
 				break;
 			}
 			case Opcode::JumpFalse:
 			{
 				trace_op();
-				int addr = Code::read_integer(ip);
+				auto target = code->data() + Code::read_integer(ip);
 				bool value = peek().to_boolean();
 				pop();
-				if (!value) ip = code->data() + addr;
+				if (!value)
+				{
+					if (target < ip) {
+						CHECKPOINT();
+					}
+					ip = target;
+				}
 				break;
 			}
 			case Opcode::JumpTrue:
@@ -894,7 +979,7 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::NewClosure:
 			{
 				trace_op();
-				const int index = *ip++;
+				const auto index = READ_CONSTANT();
 				const int narg = *ip++;
 				auto r = routine.get_routine(index);
 				if (!r->sealed())
@@ -952,9 +1037,16 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 				else if (check_type<Regex>(v)) {
 					push(make_handle<RegexIterator>(std::move(v), ref_val));
 				}
+				else if (check_type<RegexIterator>(v)) {
+					// Returned by find_all(): the iterator is its own iterator.
+					push(std::move(v));
+				}
 				else if (check_type<String>(v)) {
 					push(make_handle<StringIterator>(std::move(v), ref_val));
 				}
+				else if (check_type<Range>(v)) {
+					push(make_handle<RangeIterator>(std::move(v), ref_val));
+				}
 				else {
 					RUNTIME_ERROR("Type % is not iterable", v.class_name());
 				}
@@ -977,6 +1069,7 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 				trace_op();
 				int narg = *ip++ * 2;
 				Table::Storage tab;
+				tab.reserve(narg / 2);
 				for (int i = narg; i > 0; i -= 2)
 				{
 					auto &key = peek(-i).resolve();
@@ -1126,14 +1219,14 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::PushFloat:
 			{
 				trace_op();
-				double value = routine.get_float(*ip++);
+				double value = routine.get_float(READ_CONSTANT());
 				push(value);
 				break;
 			}
 			case Opcode::PushInteger:
 			{
 				trace_op();
-				intptr_t value = routine.get_integer(*ip++);
+				intptr_t value = routine.get_integer(READ_CONSTANT());
 				push_int(value);
 				break;
 			}
@@ -1158,7 +1251,7 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::PushString:
 			{
 				trace_op();
-				String value = routine.get_string(*ip++);
+				String value = routine.get_string(READ_CONSTANT());
 				push(std::move(value));
 				break;
 			}
@@ -1197,7 +1290,7 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 			case Opcode::SetGlobal:
 			{
 				trace_op();
-				auto name = routine.get_string(*ip++);
+				auto name = routine.get_string(READ_CONSTANT());
 				auto it = globals->find(name);
 				auto &v = peek();
 				if (it == globals->end())
@@ -1288,6 +1381,12 @@ Variant Runtime::interpret(Handle <Closure> &closure)
 				CATCH_ERROR
 				RUNTIME_ERROR("[Runtime error] %", msg);
 			}
+			case Opcode::Wide:
+			{
+				trace_op();
+				wide_operand = uint32_t(*ip++) << 16;
+				break;
+			}
 			default:
 				throw error("[Internal error] Invalid opcode: %", (int)op);
 		}
@@ -1311,6 +1410,9 @@ void Runtime::disassemble(const Routine &routine, const String &name)
 
 	for (auto &r : routine.routine_pool)
 	{
+		if (r->deferred()) {
+			compiler.compile_deferred(r);
+		}
 		printf("\n");
 		disassemble(*r, r->name());
 	}
@@ -1329,7 +1431,7 @@ size_t Runtime::print_simple_instruction(const char *name)
 	return 1;
 }
 
-size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset)
+size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset, uint32_t wide)
 {
 	auto op = static_cast<Opcode>(routine.code[offset]);
 	printf("%6zu   %5d   ", offset, routine.code.get_line(offset));
@@ -1377,7 +1479,7 @@ size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset)
 		}
 		case Opcode::DefineGlobal:
 		{
-			int index = routine.code[offset + 1];
+			int index = wide | routine.code[offset + 1];
 			String value = routine.get_string(index);
 			printf("DEFINE_GLOBAL  %-5d      ; %s\n", index, value.data());
 			return 2;
@@ -1413,14 +1515,14 @@ size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset)
 		}
 		case Opcode::GetGlobal:
 		{
-			int index = routine.code[offset + 1];
+			int index = wide | routine.code[offset + 1];
 			String value = routine.get_string(index);
 			printf("GET_GLOBAL     %-5d      ; %s\n", index, value.data());
 			return 2;
 		}
 		case Opcode::GetGlobalArg:
 		{
-			int index = routine.code[offset + 1];
+			int index = wide | routine.code[offset + 1];
 			int narg = routine.code[offset + 2];
 			String value = routine.get_string(index);
 			printf("GET_GLOBAL_ARG %-5d %-5d; %s\n", index, narg, value.data());
@@ -1428,7 +1530,7 @@ size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset)
 		}
 		case Opcode::GetGlobalRef:
 		{
-			int index = routine.code[offset + 1];
+			int index = wide | routine.code[offset + 1];
 			String value = routine.get_string(index);
 			printf("GET_GLOBAL_REF %-5d      ; %s\n", index, value.data());
 			return 2;
@@ -1476,7 +1578,7 @@ size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset)
 		}
 		case Opcode::GetUniqueGlobal:
 		{
-			int index = routine.code[offset + 1];
+			int index = wide | routine.code[offset + 1];
 			String value = routine.get_string(index);
 			printf("GET_UNIQUE_GLOBAL %-5d   ; %s\n", index, value.data());
 			return 2;
@@ -1578,7 +1680,7 @@ size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset)
 		}
 		case Opcode::NewClosure:
 		{
-			int index = routine.code[offset + 1];
+			int index = wide | routine.code[offset + 1];
 			int narg = routine.code[offset + 2];
 			auto r = routine.get_routine(index);
 			printf("NEW_CLOSURE    %-3d %-5d  ; <%p>\n", index, narg, r.get());
@@ -1668,14 +1770,14 @@ size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset)
 		}
 		case Opcode::PushFloat:
 		{
-			int index = routine.code[offset + 1];
+			int index = wide | routine.code[offset + 1];
 			double value = routine.get_float(index);
 			printf("PUSH_FLOAT     %-5d      ; %f\n", index, value);
 			return 2;
 		}
 		case Opcode::PushInteger:
 		{
-			int index = routine.code[offset + 1];
+			int index = wide | routine.code[offset + 1];
 			intptr_t value = routine.get_integer(index);
 			printf("PUSH_INTEGER   %-5d      ; %" PRIdPTR "\n", index, value);
 			return 2;
@@ -1696,7 +1798,7 @@ size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset)
 		}
 		case Opcode::PushString:
 		{
-			int index = routine.code[offset + 1];
+			int index = wide | routine.code[offset + 1];
 			String value = routine.get_string(index);
 			printf("PUSH_STRING    %-5d      ; \"%s\"\n", index, value.data());
 			return 2;
@@ -1715,7 +1817,7 @@ size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset)
 		}
 		case Opcode::SetGlobal:
 		{
-			int index = routine.code[offset + 1];
+			int index = wide | routine.code[offset + 1];
 			String value = routine.get_string(index);
 			printf("SET_GLOBAL     %-5d      ; %s\n", index, value.data());
 			return 2;
@@ -1745,6 +1847,12 @@ size_t Runtime::disassemble_instruction(const Routine &routine, size_t offset)
 		{
 			return print_simple_instruction("THROW");
 		}
+		case Opcode::Wide:
+		{
+			int high = routine.code[offset + 1];
+			printf("WIDE           %-5d\n", high);
+			return 2 + disassemble_instruction(routine, offset + 2, uint32_t(high) << 16);
+		}
 		default:
 			printf("Unknown opcode %d", static_cast<int>(op));
 	}
@@ -1757,7 +1865,7 @@ Handle<Closure> Runtime::compile_file(const String &path)
 	this->clear();
 	auto ast = parser.parse_file(path);
 
-	return compiler.compile(std::move(ast));
+	return compiler.compile(ast);
 }
 
 Handle<Closure> Runtime::compile_string(const String &code)
@@ -1765,19 +1873,86 @@ Handle<Closure> Runtime::compile_string(const String &code)
 	this->clear();
 	auto ast = parser.parse_string(code);
 
-	return compiler.compile(std::move(ast));
+	return compiler.compile(ast);
 }
 
 Variant Runtime::do_file(const String &path)
 {
-	auto closure = compile_file(path);
-	return interpret(closure);
+	bool outermost = frames.empty();
+
+	try
+	{
+		auto closure = compile_file(path);
+		return execute(closure);
+	}
+	catch (...)
+	{
+		// A request to interrupt a script that failed to compile is discarded with it.
+		if (outermost) interrupt_requested = false;
+		throw;
+	}
 }
 
 Variant Runtime::do_string(const String &code)
 {
-	auto closure = compile_string(code);
-	return interpret(closure);
+	bool outermost = frames.empty();
+
+	try
+	{
+		auto closure = compile_string(code);
+		return execute(closure);
+	}
+	catch (...)
+	{
+		if (outermost) interrupt_requested = false;
+		throw;
+	}
+}
+
+Variant Runtime::execute(Handle<Closure> &closure)
+{
+	// Scripts may be run from a native function: only the outermost one gets a new budget.
+	bool outermost = frames.empty();
+	if (outermost) {
+		reset_budget();
+	}
+
+	auto state = save_state();
+
+	try
+	{
+		auto result = interpret(closure);
+		// Interrupt requests stay pending until the outermost run is over, so that a request made while the script is
+		// being compiled or just before it starts is not lost.
+		if (outermost) interrupt_requested = false;
+
+		return result;
+	}
+	catch (...)
+	{
+		restore_state(state);
+		if (outermost) interrupt_requested = false;
+		throw;
+	}
+}
+
+Runtime::ExecutionState Runtime::save_state() const
+{
+	return { frames.size(), top, current_frame, current_routine, code, ip, needs_ref, calling_method };
+}
+
+void Runtime::restore_state(const ExecutionState &state)
+{
+	frames.resize(state.depth);
+	while (top > state.top) {
+		(--top)->~Variant();
+	}
+	current_frame = state.frame;
+	current_routine = state.routine;
+	code = state.code;
+	ip = state.ip;
+	needs_ref = state.needs_ref;
+	calling_method = state.calling_method;
 }
 
 int Runtime::get_current_line() const
@@ -1857,6 +2032,21 @@ void Runtime::add_global(const String &name, NativeCallback cb, std::initializer
 	(*globals)[name] = make_handle<Function>(this, this, name, std::move(cb), sig, ref);
 }
 
+void Runtime::reset_globals()
+{
+	std::vector<String> names;
+
+	for (auto &global : *globals)
+	{
+		if (builtin_globals.find(global.first) == builtin_globals.end()) {
+			names.push_back(global.first);
+		}
+	}
+	for (auto &name : names) {
+		globals->erase(name);
+	}
+}
+
 void Runtime::get_index(int count, bool by_ref)
 {
 	needs_ref = by_ref;
@@ -1931,6 +2121,191 @@ void Runtime::set_debug_mode(bool value)
 	debugging = value;
 }
 
+void Runtime::start_profiler(int interval)
+{
+	profiler = std::make_unique<Profiler>(interval);
+	profiler_countdown = interval;
+	update_instrumentation();
+}
+
+std::unique_ptr<Profiler> Runtime::stop_profiler()
+{
+	auto result = std::move(profiler);
+	update_instrumentation();
+
+	return result;
+}
+
+void Runtime::start_opcode_stats()
+{
+	opcode_stats = std::make_unique<OpcodeStats>();
+	update_instrumentation();
+}
+
+std::unique_ptr<OpcodeStats> Runtime::stop_opcode_stats()
+{
+	auto result = std::move(opcode_stats);
+	update_instrumentation();
+
+	return result;
+}
+
+void Runtime::enable_memory_stats()
+{
+	if (!memory_tracker)
+	{
+		memory_tracker = std::make_unique<utils::MemoryTracker>();
+		utils::set_memory_tracker(memory_tracker.get());
+
+		// Objects allocated by a previous tracker are no longer accounted for.
+		for (auto &cls : classes) {
+			cls->memory = utils::MemoryUsage();
+		}
+	}
+}
+
+void Runtime::disable_memory_stats()
+{
+	if (memory_tracker)
+	{
+		if (utils::get_memory_tracker() == memory_tracker.get()) {
+			utils::set_memory_tracker(nullptr);
+		}
+		memory_tracker.reset();
+		update_instrumentation();
+	}
+}
+
+void Runtime::set_memory_limit(intptr_t bytes)
+{
+	if (bytes < 0) {
+		throw error("[Memory error] Memory limit cannot be negative");
+	}
+	enable_memory_stats();
+	memory_tracker->set_limit(bytes);
+	update_instrumentation();
+}
+
+void Runtime::interrupt()
+{
+	interrupt_requested = true;
+}
+
+void Runtime::set_step_limit(intptr_t steps)
+{
+	if (steps < 0) {
+		throw error("[Limit error] Step limit cannot be negative");
+	}
+	step_limit = steps;
+}
+
+void Runtime::set_time_limit(std::chrono::milliseconds duration)
+{
+	if (duration.count() < 0) {
+		throw error("[Limit error] Time limit cannot be negative");
+	}
+	time_limit = duration;
+}
+
+void Runtime::reset_budget()
+{
+	step_count = 0;
+	deadline = std::chrono::steady_clock::now() + time_limit;
+	budget_interval = step_limit > 0 ? int((std::min<intptr_t>)(BudgetInterval, step_limit + 1)) : BudgetInterval;
+	budget_countdown = budget_interval;
+}
+
+void Runtime::check_budget()
+{
+	step_count += budget_interval;
+
+	if (interrupt_requested) {
+		RUNTIME_ERROR("[Interrupt error] Execution was interrupted");
+	}
+	if (step_limit > 0 && step_count > step_limit) {
+		RUNTIME_ERROR("[Limit error] Script exceeded the limit of % steps", step_limit);
+	}
+	if (time_limit.count() > 0 && std::chrono::steady_clock::now() >= deadline) {
+		RUNTIME_ERROR("[Limit error] Script exceeded the time limit of % ms", intptr_t(time_limit.count()));
+	}
+
+	budget_interval = step_limit > 0 ? int((std::min<intptr_t>)(BudgetInterval, step_limit - step_count + 1)) : BudgetInterval;
+	budget_countdown = budget_interval;
+}
+
+void Runtime::update_instrumentation()
+{
+	instrumented = profiler || opcode_stats || (memory_tracker && memory_tracker->limit() > 0);
+}
+
+void Runtime::instrument(Opcode op)
+{
+	if (opcode_stats) {
+		opcode_stats->record(op);
+	}
+	if (profiler && --profiler_countdown == 0) {
+		take_sample();
+	}
+	if (memory_tracker && memory_tracker->over_limit()) {
+		check_memory_limit();
+	}
+}
+
+void Runtime::check_memory_limit()
+{
+	// Unreachable cycles may account for some of the memory in use.
+	collect();
+
+	if (memory_tracker->over_limit())
+	{
+		RUNTIME_ERROR("[Memory error] Memory limit exceeded: % bytes in use, the limit is % bytes",
+				memory_tracker->total().bytes, memory_tracker->limit());
+	}
+}
+
+void Runtime::take_sample()
+{
+	profiler_countdown = profiler->interval();
+
+	auto get_frame = [](const Routine *r, const Instruction *pc) -> Profiler::Frame {
+		String name;
+		if (r->parent == nullptr) {
+			name = "<main>";
+		}
+		else
+		{
+			name = r->name().empty() ? String("<anonymous>") : r->name();
+			name.append(':');
+			name.append(String::convert(intptr_t(r->code.get_line(0))));
+		}
+
+		// The return address of a caller points past its Call instruction.
+		int line = 0;
+		auto offset = pc ? intptr_t(pc - 1 - r->code.data()) : -1;
+		if (offset >= 0 && offset < intptr_t(r->code.size())) {
+			line = r->code.get_line(int(offset));
+		}
+
+		return { std::move(name), line };
+	};
+
+	std::vector<Profiler::Frame> stack;
+	const Routine *innermost = nullptr;
+
+	for (size_t i = 0; i < frames.size(); i++)
+	{
+		auto r = static_cast<const Routine*>(frames[i]->current_closure->value().routine.get());
+		bool top_frame = (i + 1 == frames.size() && r == current_routine);
+		stack.push_back(get_frame(r, top_frame ? ip : frames[i]->ip));
+		innermost = r;
+	}
+	// A routine which has just been called doesn't have a frame until it executes NewFrame.
+	if (current_routine && innermost != current_routine) {
+		stack.push_back(get_frame(current_routine, ip));
+	}
+	profiler->add_sample(stack);
+}
+
 void Runtime::report_call_error(const Function &func, std::span<Variant> args)
 {
 	Array<String> types;
@@ -2106,6 +2481,69 @@ Variant Runtime::call_method(Handle<Closure> &c, std::span<Variant> args)
 	}
 }
 
+Variant Runtime::call(Function &func, std::span<Variant> args)
+{
+	auto c = func.find_closure(args);
+	if (!c) {
+		report_call_error(func, args);
+	}
+
+	if (c->routine->is_native())
+	{
+		auto &r = reinterpret_cast<NativeRoutine&>(*(c->routine));
+		return r(*this, args);
+	}
+
+	// Lay out the stack as the Call instruction would: a slot for the function, followed by the arguments. The
+	// function slot is popped by the callee when it returns.
+	ensure_capacity(int(args.size()) + 1);
+	push_null();
+	for (auto &arg : args) {
+		push(arg);
+	}
+	top -= args.size();
+	current_frame->ip = ip;
+
+	auto method_flag = calling_method;
+	auto ref_flag = needs_ref;
+	calling_method = false;
+	needs_ref = false;
+	auto v = interpret(c);
+	calling_method = method_flag;
+	needs_ref = ref_flag;
+
+	return v;
+}
+
+Variant Runtime::call_protected(Function &func, std::span<Variant> args)
+{
+	auto state = save_state();
+
+	try
+	{
+		return call(func, args);
+	}
+	catch (RuntimeError &)
+	{
+		restore_state(state);
+		throw;
+	}
+	catch (std::exception &e)
+	{
+		// Errors from native code don't carry a line number: report the line of the current instruction.
+		auto line = code ? get_current_line() : 0;
+		restore_state(state);
+		throw RuntimeError(line, e.what());
+	}
+}
+
+bool Runtime::out_of_budget() const
+{
+	return interrupt_requested || (step_limit > 0 && step_count > step_limit) ||
+			(time_limit.count() > 0 && std::chrono::steady_clock::now() >= deadline) ||
+			(memory_tracker && memory_tracker->over_limit());
+}
+
 Collectable *Runtime::pop_candidate()
 {
 	auto cand = gc_root;
@@ -2124,4 +2562,6 @@ Collectable *Runtime::pop_candidate()
 
 #undef CATCH_ERROR
 #undef RUNTIME_ERROR
+#undef READ_CONSTANT
+#undef CHECKPOINT
 #undef trace_op
\ No newline at end of file
@@ -16,6 +16,8 @@
 #ifndef PHONOMETRICA_RUNTIME_HPP
 #define PHONOMETRICA_RUNTIME_HPP
 
+#include <atomic>
+#include <chrono>
 #include <type_traits>
 #include <unordered_set>
 #include <phon/string.hpp>
@@ -32,6 +34,7 @@
 #include <phon/runtime/compiler/parser.hpp>
 #include <phon/runtime/code.hpp>
 #include <phon/runtime/compiler/compiler.hpp>
+#include <phon/runtime/profiler.hpp>
 
 namespace phonometrica {
 
@@ -187,6 +190,18 @@ public:
 
 	Variant interpret(Handle<Closure> &closure);
 
+	// Call a function from native code. This can only be used while the runtime is executing code, e.g. from a builtin
+	// function which receives a callback.
+	Variant call(Function &func, std::span<Variant> args);
+
+	// Like call(), but if the function raises an error, the runtime is restored to the state it was in before the call
+	// and the error is rethrown as a RuntimeError.
+	Variant call_protected(Function &func, std::span<Variant> args);
+
+	// Check whether the running script has exhausted its budget (interrupt request, step, time or memory limit). Errors
+	// raised because of this must not be caught by scripts.
+	bool out_of_budget() const;
+
 	void disassemble(const Closure &closure, const String &name);
 
 	void disassemble(const Routine &routine, const String &name);
@@ -205,6 +220,9 @@ public:
 
 	void add_global(const String &name, NativeCallback cb, std::initializer_list<Handle<Class>> sig, ParamBitset ref = ParamBitset());
 
+	// Remove the global variables that were defined after the runtime was created, so that a script can be run again.
+	void reset_globals();
+
 	bool needs_reference() const;
 
 	Variant &operator[](const String &key);
@@ -217,6 +235,47 @@ public:
 
 	void resume_gc();
 
+	// Sample the call stack every `interval` instructions. A previous profile, if any, is discarded.
+	void start_profiler(int interval = Profiler::DefaultInterval);
+
+	// Stop sampling and return the profile collected so far, or null if the profiler was not running.
+	std::unique_ptr<Profiler> stop_profiler();
+
+	// Count executed opcodes and opcode pairs. Previous statistics, if any, are discarded.
+	void start_opcode_stats();
+
+	// Stop counting and return the statistics collected so far, or null if they were not enabled.
+	std::unique_ptr<OpcodeStats> stop_opcode_stats();
+
+	// Account for the memory allocated by the current thread. Memory allocated before this call is not accounted for.
+	void enable_memory_stats();
+
+	// Stop accounting for memory. This also removes the memory limit.
+	void disable_memory_stats();
+
+	// Memory statistics collected so far, or null if memory accounting is disabled.
+	const utils::MemoryTracker *memory_stats() const { return memory_tracker.get(); }
+
+	// Builtin classes. Each class records the memory used by its instances while memory is being accounted for.
+	const std::vector<Handle<Class>> &get_classes() const { return classes; }
+
+	// Raise an error when more than `bytes` of memory are in use (0 removes the limit). The limit is checked between
+	// instructions, after trying to reclaim memory. This enables memory accounting if needed.
+	void set_memory_limit(intptr_t bytes);
+
+	// Ask the running script to stop. This can be called from any thread: the runtime raises an error at the next
+	// checkpoint (a backward jump or a function call). The request stays pending until the current call to do_file() or
+	// do_string() is over, so a request made while the script is being compiled, or while no script is running, stops
+	// the next script that reaches a checkpoint.
+	void interrupt();
+
+	// Limit the number of steps (loop iterations and function calls) in each call to do_file() or do_string(). 0 removes
+	// the limit.
+	void set_step_limit(intptr_t steps);
+
+	// Limit the duration of each call to do_file() or do_string(). 0 removes the limit.
+	void set_time_limit(std::chrono::milliseconds duration);
+
 private:
 
 	struct CallFrame
@@ -238,6 +297,23 @@ private:
 
 		// Number of local variables.
 		int nlocal = -1;
+
+		static void *operator new(size_t size) { return utils::alloc(intptr_t(size), utils::MemoryCategory::Frames); }
+
+		static void operator delete(void *ptr) { utils::free(ptr, utils::MemoryCategory::Frames); }
+	};
+
+	// State of the interpreter before running code that may fail, so that the runtime can be used again afterwards.
+	struct ExecutionState
+	{
+		size_t depth;
+		Variant *top;
+		CallFrame *frame;
+		const Routine *routine;
+		const Code *code;
+		const Instruction *ip;
+		bool needs_ref;
+		bool calling_method;
 	};
 
 	friend class Object;
@@ -261,7 +337,7 @@ private:
 
 	Variant *var();
 
-	size_t disassemble_instruction(const Routine &routine, size_t offset);
+	size_t disassemble_instruction(const Routine &routine, size_t offset, uint32_t wide = 0);
 
 	static size_t print_simple_instruction(const char *name);
 
@@ -269,10 +345,31 @@ private:
 
 	void math_op(char op);
 
+	Variant array_math_op(char op, const Variant &v1, const Variant &v2);
+
 	static void check_float_error();
 
 	int get_current_line() const;
 
+	void take_sample();
+
+	void instrument(Opcode op);
+
+	void update_instrumentation();
+
+	Variant execute(Handle<Closure> &closure);
+
+	ExecutionState save_state() const;
+
+	// Unwind the stack and the call frames down to a saved state.
+	void restore_state(const ExecutionState &state);
+
+	void reset_budget();
+
+	void check_budget();
+
+	void check_memory_limit();
+
 	void push_call_frame(TObject<Closure> *closure, int nlocal);
 
 	Variant pop_call_frame();
@@ -336,6 +433,9 @@ private:
 	// Global variables.
 	Handle<Module> globals;
 
+	// Names of the global variables defined by the runtime itself.
+	std::unordered_set<String> builtin_globals;
+
 	// Stack of call frames.
 	std::vector<std::unique_ptr<CallFrame>> frames;
 
@@ -354,6 +454,40 @@ private:
 	// Runtime options.
 	bool debugging = true;
 
+	// Profiler, if profiling is enabled.
+	std::unique_ptr<Profiler> profiler;
+
+	// Number of instructions left before the next sample.
+	int profiler_countdown = 0;
+
+	// Opcode statistics, if enabled.
+	std::unique_ptr<OpcodeStats> opcode_stats;
+
+	// Memory accounting, if enabled.
+	std::unique_ptr<utils::MemoryTracker> memory_tracker;
+
+	// The budget is checked at checkpoints (backward jumps and function calls), but we only poll the interrupt flag,
+	// the step limit and the clock every `BudgetInterval` checkpoints.
+	static constexpr int BudgetInterval = 1024;
+
+	// Number of checkpoints left before the budget is checked, and number of checkpoints between the last two checks.
+	int budget_countdown = BudgetInterval;
+	int budget_interval = BudgetInterval;
+
+	// Maximum number of steps in a script (0 if there is no limit), and number of steps executed so far.
+	intptr_t step_limit = 0;
+	intptr_t step_count = 0;
+
+	// Maximum duration of a script (0 if there is no limit), and the time at which the current script must stop.
+	std::chrono::milliseconds time_limit{0};
+	std::chrono::steady_clock::time_point deadline;
+
+	// Set by interrupt(), possibly from another thread.
+	std::atomic<bool> interrupt_requested{false};
+
+	// True if the profiler, opcode statistics or a memory limit are enabled. This lets the interpreter check a single flag.
+	bool instrumented = false;
+
 	// Flag to let functions know whether a reference is requested.
 	bool needs_ref = false;
 
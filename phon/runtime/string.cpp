@@ -12,6 +12,7 @@
  *                                                                                                                    *
  **********************************************************************************************************************/
 
+#include <algorithm>
 #include <cstring>
 #include <cstdarg>
 #include <cmath>
@@ -19,6 +20,7 @@
 #include <phon/error.hpp>
 #include <phon/utils/alloc.hpp>
 #include <phon/utils/helpers.hpp>
+#include <phon/utils/string_search.hpp>
 #include <phon/regex.hpp>
 
 #include <phon/third_party/utf8/utf8.h>
@@ -82,9 +84,10 @@ void String::reserve(intptr_t requested)
 {
 	if (this->shared() || !check_capacity(requested))
 	{
-		auto new_capacity = utils::find_capacity(requested, this->capacity());
+		// A slice has no capacity of its own.
+		auto new_capacity = utils::find_capacity(requested, (std::max<intptr_t>)(this->capacity(), meta::pointer_size));
 		String tmp(new_capacity);
-		char_traits::copy(tmp.chars(), this->data(), this->size());
+		char_traits::copy(tmp.chars(), this->cbegin(), this->size());
 		tmp.adjust(this->size());
 		swap(tmp);
 	}
@@ -92,12 +95,12 @@ void String::reserve(intptr_t requested)
 
 bool String::check_capacity(intptr_t requested) const
 {
-	return impl->data + requested < impl->limit;
+	return impl->start + requested < impl->limit;
 }
 
 void String::adjust(intptr_t new_size)
 {
-	impl->end = impl->data + new_size;
+	impl->end = impl->start + new_size;
 	*impl->end = 0;
 	impl->reset();
 }
@@ -134,27 +137,28 @@ bool String::operator>=(const String &other) const
 
 bool String::operator==(const String &other) const
 {
-	return impl == other.impl || equals(other.data(), other.size());
+	return impl == other.impl || equals(other.cbegin(), other.size());
 }
 
 bool String::operator!=(const String &other) const
 {
-	return !equals(other.data(), other.size());
+	return !equals(other.cbegin(), other.size());
 }
 
 int String::compare(Substring other) const
 {
-	return compare(other.data());
+	// Like strcmp(), string_view compares bytes as unsigned characters, but it doesn't need a null terminator.
+	return view().compare(other);
 }
 
 int String::compare(const String &other) const
 {
-	return compare(other.data());
+	return compare(other.view());
 }
 
 int String::compare(const char *other) const
 {
-	return strcmp(this->data(), other);
+	return compare(Substring(other));
 }
 
 String &String::operator=(const String &other)
@@ -200,7 +204,7 @@ String &String::insert(String::iterator pos, Substring infix)
 	// Make room for the infix. We don't call reserve() or unshare().
 	if (this->shared() || !check_capacity(new_size + 1))
 	{
-		auto capacity = utils::find_capacity(new_size + 1, this->capacity());
+		auto capacity = utils::find_capacity(new_size + 1, (std::max<intptr_t>)(this->capacity(), meta::pointer_size));
 
 		String tmp(capacity);
 		// Copy head up to the insertion point.
@@ -231,7 +235,7 @@ String &String::insert(String::iterator pos, Substring infix)
 
 void String::unshare()
 {
-	String tmp(this->data(), this->size());
+	String tmp(this->cbegin(), this->size());
 	this->swap(tmp);
 }
 
@@ -246,7 +250,7 @@ size_t String::hash() const
 
 	if (h == 0 && !this->empty())
 	{
-		h = hash_chars<sizeof(size_t)>(this->data(), size_t(this->size()), utils::random_seed());
+		h = hash_chars<sizeof(size_t)>(this->cbegin(), size_t(this->size()), utils::random_seed());
 		impl->hash = h;
 	}
 
@@ -309,7 +313,7 @@ void String::push_back(char c)
 }
 
 String::Data::Data(const char *str, intptr_t len, intptr_t capacity) :
-		end(data + len), limit(data + capacity)
+		start(data), end(data + len), limit(data + capacity)
 {
 	if (str)
 	{
@@ -319,9 +323,34 @@ String::Data::Data(const char *str, intptr_t len, intptr_t capacity) :
 	*end = 0;
 }
 
+String::Data::Data(Data *parent, const char *str, intptr_t len) :
+		start(const_cast<char*>(str)), end(start + len), limit(start)
+{
+	// Slice the string that owns the buffer, so that slices never form chains.
+	if (parent->is_slice()) {
+		parent = parent->parent;
+	}
+	// The slice shares the parent's null terminator.
+	assert(parent->start <= start && end == parent->end);
+	parent->retain();
+	this->parent = parent;
+
+	// Any fragment of a string made of single-byte graphemes has the same property.
+	if (parent->ascii == AsciiSimple) {
+		ascii = AsciiSimple;
+	}
+}
+
+String::Data::~Data()
+{
+	if (is_slice()) {
+		parent->release();
+	}
+}
+
 void String::Data::operator delete(void* ptr, size_t)
 {
-	utils::free(ptr);
+	utils::free(ptr, utils::MemoryCategory::Strings);
 }
 
 IntrusivePtr<String::Data> String::Data::create(intptr_t capacity, bool exact)
@@ -341,19 +370,45 @@ IntrusivePtr<String::Data> String::Data::create(const char *str, intptr_t len)
 IntrusivePtr<String::Data> String::Data::create(const char *str, intptr_t len, intptr_t capacity)
 {
 	constexpr intptr_t base_size = sizeof(Data) - meta::pointer_size;
-	auto self = utils::alloc(base_size + capacity);
+	auto self = utils::alloc(base_size + capacity, utils::MemoryCategory::Strings);
 	auto data = new (self) Data(str, len, capacity);
 
 	return IntrusivePtr<Data>(data, IntrusivePtr<Data>::Raw());
 }
 
+IntrusivePtr<String::Data> String::Data::create_slice(Data *parent, const char *str, intptr_t len)
+{
+	auto self = utils::alloc(sizeof(Data), utils::MemoryCategory::Strings);
+	auto data = new (self) Data(parent, str, len);
+
+	return IntrusivePtr<Data>(data, IntrusivePtr<Data>::Raw());
+}
+
 void String::Data::reset()
 {
 	hash = 0;
 	length = 0;
+	ascii = AsciiUnknown;
 	*end = 0;
 }
 
+uint32_t String::ascii_state() const
+{
+	if (impl->ascii == Data::AsciiUnknown)
+	{
+		auto len = size_t(this->size());
+
+		if (!utils::is_ascii(impl->start, len))
+			impl->ascii = Data::NonAscii;
+		else if (len > 1 && utils::find_substring(impl->start, len, "\r\n", 2))
+			impl->ascii = Data::AsciiCrLf;
+		else
+			impl->ascii = Data::AsciiSimple;
+	}
+
+	return impl->ascii;
+}
+
 
 Substring String::next_grapheme(String::const_iterator &it) const
 {
@@ -371,6 +426,12 @@ void String::next_grapheme(String::const_iterator &it, intptr_t &len) const
 		len = 0;
 		return;
 	}
+	if (single_byte_graphemes())
+	{
+		len = 1;
+		it++;
+		return;
+	}
 	auto start = it;
 	char32_t current_codepoint = 0;
 	char32_t next_codepoint = impl->next_codepoint(it);
@@ -400,6 +461,12 @@ void String::previous_grapheme(String::const_iterator &it, intptr_t &len) const
 		len = 0;
 		return;
 	}
+	if (single_byte_graphemes())
+	{
+		len = 1;
+		it--;
+		return;
+	}
 
 	auto end = it;
 	char32_t current_codepoint = 0;
@@ -434,6 +501,16 @@ void String::advance(String::const_iterator &it, intptr_t count) const
 {
 	intptr_t len;
 
+	if (single_byte_graphemes())
+	{
+		if (count >= 0)
+			it += (std::min)(count, intptr_t(this->cend() - it));
+		else
+			it -= (std::min)(-count, intptr_t(it - this->cbegin()));
+
+		return;
+	}
+
 	if (count >= 0)
 	{
 		while (count-- != 0 && it != this->cend())
@@ -455,6 +532,10 @@ intptr_t String::distance(String::const_iterator from, String::const_iterator to
 	assert(from <= to);
 	intptr_t len, dist = 0;
 
+	if (single_byte_graphemes()) {
+		return intptr_t(to - from);
+	}
+
 	while (from != to)
 	{
 		next_grapheme(from, len);
@@ -497,7 +578,7 @@ char32_t String::Data::previous_codepoint(String::const_iterator &it) const
 	// See https://stackoverflow.com/a/22257843
 	do
 	{
-		if (it <= this->data)
+		if (it <= this->start)
 		{
 			throw error("[Unicode error] Cannot access code point before the beginning of the string");
 		}
@@ -519,6 +600,10 @@ intptr_t String::grapheme_count() const
 {
 	if (impl->length == 0 && !this->empty())
 	{
+		if (single_byte_graphemes()) {
+			return this->size();
+		}
+
 		auto it = begin();
 		uint32_t count = 1;
 		char32_t current_codepoint = 0;
@@ -535,6 +620,10 @@ intptr_t String::grapheme_count() const
 			}
 		}
 
+		// The cache is 30 bits wide: very long strings are recounted each time.
+		if (count >= (1u << 30)) {
+			return intptr_t(count);
+		}
 		impl->length = count;
 	}
 
@@ -631,15 +720,8 @@ bool String::contains(char32_t codepoint) const
 {
 	if (this->empty()) return false;
 
-	if (codepoint < 128)
-	{
-		auto ch = char(codepoint);
-
-		for (auto c : *this) {
-			if (c == ch) return true;
-		}
-
-		return false;
+	if (codepoint < 128) {
+		return memchr(cbegin(), int(codepoint), size_t(size())) != nullptr;
 	}
 
 	return contains(encode(codepoint));
@@ -647,19 +729,13 @@ bool String::contains(char32_t codepoint) const
 
 bool String::contains(Substring haystack, Substring needle)
 {
-#ifdef __APPLE__
-	auto it = std::search(haystack.begin(), haystack.end(), needle.begin(), needle.end());
-#else
-	auto it = std::search(haystack.begin(), haystack.end(), std::boyer_moore_searcher(needle.begin(), needle.end()));
-#endif
-
-	return it != haystack.end();
+	return utils::find_substring(haystack.data(), haystack.size(), needle.data(), needle.size()) != nullptr;
 }
 
 bool String::starts_with(Substring prefix) const
 {
 	return prefix.size() <= size_t(this->size()) &&
-	       char_traits::compare(this->data(), prefix.data(), prefix.size()) == 0;
+	       char_traits::compare(this->cbegin(), prefix.data(), prefix.size()) == 0;
 }
 
 bool String::starts_with(char32_t codepoint) const
@@ -740,7 +816,7 @@ String &String::trim(String::Option flag)
 	{
 		for (; first < len; first++)
 		{
-			if (!isspace(impl->data[first])) {
+			if (!isspace(static_cast<unsigned char>(impl->start[first]))) {
 				break;
 			}
 		}
@@ -750,7 +826,7 @@ String &String::trim(String::Option flag)
 	{
 		for (; last > first; --last)
 		{
-			if (!isspace(impl->data[last - 1])) {
+			if (!isspace(static_cast<unsigned char>(impl->start[last - 1]))) {
 				break;
 			}
 		}
@@ -763,7 +839,7 @@ String &String::trim(String::Option flag)
 		// Unshare manually to avoid copying and moving.
 		if (this->shared())
 		{
-			String tmp(this->data() + first, new_size);
+			String tmp(this->cbegin() + first, new_size);
 			this->swap(tmp);
 		}
 		else
@@ -783,7 +859,7 @@ String &String::trim_new_line()
 
 	for (; last > 0; --last)
 	{
-		char c = impl->data[last - 1];
+		char c = impl->start[last - 1];
 
 		if (c != '\n' && c != '\r') {
 			break;
@@ -797,7 +873,7 @@ String &String::trim_new_line()
 		// Unshare manually to avoid copying and moving.
 		if (this->shared())
 		{
-			String tmp(this->data(), new_size);
+			String tmp(this->cbegin(), new_size);
 			this->swap(tmp);
 		}
 		else
@@ -830,16 +906,11 @@ intptr_t String::count(Substring substring) const
 
 intptr_t String::count(Substring self, Substring substring)
 {
-	intptr_t total = 0;
-	size_t at = 0;
-
-	while (at < self.size() && (at = self.find(substring, at)) != Substring::npos)
-	{
-		total++;
-		at += substring.size();
+	if (substring.empty()) {
+		return 0;
 	}
 
-	return total;
+	return intptr_t(utils::count_substring(self.data(), self.size(), substring.data(), substring.size()));
 }
 
 String String::repeat(intptr_t count) const
@@ -972,11 +1043,8 @@ intptr_t String::find(Substring substring, intptr_t from) const
 
 String::const_iterator String::find(Substring substring, const_iterator from) const
 {
-#ifdef __APPLE__
-	return std::search(from, this->end(), substring.begin(), substring.end());
-#else
-	return std::search(from, this->end(), std::boyer_moore_searcher(substring.begin(), substring.end()));
-#endif
+	auto result = utils::find_substring(from, size_t(end() - from), substring.data(), substring.size());
+	return result ? result : end();
 }
 
 intptr_t String::find(char32_t c, intptr_t from) const
@@ -989,14 +1057,8 @@ String::const_iterator String::find(char32_t c, String::const_iterator from) con
 {
 	if (c < 128)
 	{
-		for (auto it = from; it != end(); it++)
-		{
-			if (*it == char(c)) {
-				return it;
-			}
-		}
-
-		return end(); // not found
+		auto result = memchr(from, int(c), size_t(end() - from));
+		return result ? static_cast<const_iterator>(result) : end();
 	}
 
 	return find(encode(c), from);
@@ -1020,6 +1082,10 @@ String::const_iterator String::rfind(Substring infix, String::const_iterator pos
 
 String String::to_upper() const
 {
+	if (is_ascii()) {
+		return map_ascii(true);
+	}
+
 	String result(this->size());
 	auto it = begin();
 
@@ -1034,6 +1100,10 @@ String String::to_upper() const
 
 String String::to_lower() const
 {
+	if (is_ascii()) {
+		return map_ascii(false);
+	}
+
 	String result(this->size());
 	auto it = begin();
 
@@ -1089,8 +1159,36 @@ String String::convert(double n)
 	return String(buffer);
 }
 
+String String::map_ascii(bool upper) const
+{
+	auto len = this->size();
+	String result(len + 1);
+	char first = upper ? 'a' : 'A';
+	char last = upper ? 'z' : 'Z';
+
+	for (intptr_t i = 0; i < len; i++)
+	{
+		char c = impl->start[i];
+		result.impl->data[i] = (c >= first && c <= last) ? char(c ^ 0x20) : c;
+	}
+	result.adjust(len);
+	// Case mapping doesn't affect line breaks.
+	result.impl->ascii = impl->ascii;
+
+	return result;
+}
+
 String String::reverse() const
 {
+	if (single_byte_graphemes())
+	{
+		String result(begin(), this->size());
+		std::reverse(result.impl->data, result.impl->end);
+		result.impl->ascii = Data::AsciiSimple;
+
+		return result;
+	}
+
 	String result(this->size());
 	auto it = end();
 
@@ -1151,51 +1249,65 @@ String &String::replace(const_iterator from, const_iterator to, Substring after)
 
 String &String::replace(Substring before, Substring after, intptr_t ntimes)
 {
-	auto pos = begin();
-	intptr_t counter = 0;
-
+	if (before.empty() || ntimes == 0) {
+		return *this;
+	}
 	if (ntimes < 0) ntimes = (std::numeric_limits<intptr_t>::max)();
 
-	while (pos < end() && counter < ntimes)
-	{
-		pos = const_cast<iterator>(find(before, pos));
-		intptr_t offset = pos - begin();
+	// Count the matches first, so that the result can be built with at most one allocation.
+	auto text = view();
+	auto limit = text.data() + text.size();
+	intptr_t count = 0;
 
-		if (pos != end())
-		{
-			this->replace(pos, pos + before.size(), after);
-			// The string might have been reallocated because it was shared or because its capacity was too limited,
-			// so we recompute the position.
-			pos = begin() + offset + after.size();
-			++counter;
-		}
+	for (auto p = text.data(); count < ntimes; count++)
+	{
+		p = utils::find_substring(p, size_t(limit - p), before.data(), before.size());
+		if (!p) break;
+		p += before.size();
 	}
 
-	return *this;
-}
-
-String &String::replace(Regex &pattern, String after, intptr_t ntimes)
-{
-	if (pattern.match(*this))
-	{
-		auto start = pattern.capture_start_iter(0);
-		auto end = pattern.capture_end_iter(0);
+	if (count == 0) {
+		return *this;
+	}
 
-		// Replace whole match (same as Perl's $&)
-		after.replace("%%", pattern.capture(0), ntimes);
+	intptr_t new_size = this->size() + count * (intptr_t(after.size()) - intptr_t(before.size()));
+	const bool in_place = !this->shared() && after.size() <= before.size();
+	String tmp;
 
-		// At most 9 captures can be replaced
-		auto count = std::min<intptr_t>(pattern.count(), 9);
+	if (!in_place) {
+		tmp = String(new_size + 1);
+	}
+	// If the result is not longer than the original string, we write it in place: the destination never overtakes the
+	// source, and a match is always found before it is overwritten.
+	char *out = in_place ? chars() : tmp.chars();
+	auto src = text.data();
 
-		for (intptr_t i = 1; i <= count; ++i)
-		{
-			String num = String::format("%%%td", i);
-			after.replace(num, pattern.capture(i), ntimes);
-		}
+	for (intptr_t i = 0; i < count; i++)
+	{
+		auto p = utils::find_substring(src, size_t(limit - src), before.data(), before.size());
+		auto len = size_t(p - src);
+		memmove(out, src, len);
+		out += len;
+		memcpy(out, after.data(), after.size());
+		out += after.size();
+		src = p + before.size();
+	}
+	memmove(out, src, size_t(limit - src));
 
-		replace(start, end, after);
+	if (in_place) {
+		adjust(new_size);
 	}
+	else {
+		tmp.adjust(new_size);
+		this->swap(tmp);
+	}
+
+	return *this;
+}
 
+String &String::replace(Regex &pattern, String after, intptr_t ntimes)
+{
+	*this = pattern.replace(*this, after, ntimes);
 	return *this;
 }
 
@@ -1205,9 +1317,10 @@ String &String::replace(char before, char after)
 
 	for (intptr_t i = 0; i < this->size(); i++)
 	{
-		if (impl->data[i] == before)
-			impl->data[i] = after;
+		if (impl->start[i] == before)
+			impl->start[i] = after;
 	}
+	impl->reset();
 
 	return *this;
 }
@@ -1229,7 +1342,7 @@ String String::left(intptr_t count) const
 	auto it = begin();
 	advance(it, count);
 
-	return mid(begin(), it);
+	return slice(begin(), it - begin());
 }
 
 String String::right(intptr_t count) const
@@ -1237,7 +1350,7 @@ String String::right(intptr_t count) const
 	auto it = end();
 	advance(it, -count);
 
-	return mid(it, end());
+	return slice(it, end() - it);
 }
 
 String &String::replace_first(Substring before, Substring after)
@@ -1316,55 +1429,56 @@ Array<String> String::split(Substring separator) const
 		throw error("[Runtime error] Cannot split string with empty delimiter");
 	}
 	Array<String> strings;
-	intptr_t substring_start;
-	intptr_t string_last; /* end position accounting for the size of the splitter */
-	intptr_t len;
-	intptr_t string_size = this->size();
-	const char *substring, *current_chunk;
+	auto text = view();
 
-	/* The splitter needs to be longer than the string to be split */
-	if (intptr_t(separator.size()) >= string_size)
+	// The splitter needs to be shorter than the string to be split. In this case, we share the string.
+	if (separator.size() >= text.size())
 	{
 		strings.push_back(*this);
 		return strings;
 	}
 
-	substring_start = 0;
-	string_last = string_size - separator.size();
+	auto start = text.data();
+	auto limit = start + text.size();
+	const char *pos;
 
-	for (intptr_t i = 0; i <= string_last; ++i)
+	while ((pos = utils::find_substring(start, size_t(limit - start), separator.data(), separator.size())) != nullptr)
 	{
-		current_chunk = data() + i;
-
-		if (char_traits::compare(current_chunk, separator.data(), separator.size()) == 0)
-		{
-			/* Get the length of the current unmatched text */
-			len = i - substring_start;
-
-			/* Get pointer to current substring */
-			substring = data() + substring_start;
+		strings.append(fragment(start, intptr_t(pos - start)));
+		start = pos + separator.size();
+	}
+	strings.append(slice(start, intptr_t(limit - start)));
 
-			/* Add string to string list */
-			strings.append(String(substring, len));
+	return strings;
+}
 
-			/* Skip the replaced chunk */
-			substring_start = i + separator.size();
-			i = substring_start - 1;
-		}
+String String::fragment(const char *str, intptr_t len)
+{
+	if (len == 0) {
+		return String();
 	}
+	// Fragments are rarely appended to, so we allocate exactly what we need.
+	String result;
+	result.impl = Data::create(str, len, (std::max<intptr_t>)(len + 1, meta::pointer_size));
+
+	return result;
+}
 
-	/* Get right substring */
-	if (substring_start == string_size) { /* The end of the string matched the separator */
-		strings.append(String());
+String String::slice(const_iterator from, intptr_t len) const
+{
+	// Share the whole string rather than copying it.
+	if (len == this->size()) {
+		return *this;
 	}
-	else
-	{
-		len = string_size - substring_start;
-		substring = data() + substring_start;
-		strings.append(String(substring, len));
+	// A slice ends with the null terminator of the buffer it shares, and it keeps all of that buffer alive.
+	auto owner = impl->is_slice() ? impl->parent : impl.get();
+	if (from + len != end() || len < MinSliceSize || len * MaxSliceWaste < owner->limit - owner->start) {
+		return fragment(from, len);
 	}
+	String result;
+	result.impl = Data::create_slice(impl.get(), from, len);
 
-	return strings;
+	return result;
 }
 
 void String::chop(intptr_t new_size)
@@ -1375,7 +1489,7 @@ void String::chop(intptr_t new_size)
 
 	if (this->shared())
 	{
-		String tmp(this->data(), new_size);
+		String tmp(this->cbegin(), new_size);
 		this->swap(tmp);
 	}
 	else
@@ -1644,15 +1758,7 @@ String::const_iterator String::ifind(Substring substring, String::const_iterator
 
 bool String::is_ascii() const
 {
-	auto str = this->begin();
-	auto end = this->end();
-
-	while (str != end)
-	{
-		if (*str++ < 0) return false;
-	}
-
-	return true;
+	return ascii_state() != Data::NonAscii;
 }
 
 void String::shrink_to_fit()
@@ -1660,7 +1766,7 @@ void String::shrink_to_fit()
 	if (!this->empty() && this->capacity() > this->size() + this->size() / 6)
 	{
 		String tmp(this->size() + 1, true);
-		char_traits::copy(tmp.chars(), this->data(), this->size());
+		char_traits::copy(tmp.chars(), this->cbegin(), this->size());
 		tmp.adjust(this->size());
 		swap(tmp);
 	}
@@ -72,8 +72,8 @@ public:
 		NFKD  // normalization form compatibility decomposition
 	};
 	// Iterators work on code units.
-	iterator begin() noexcept { return impl->data; }
-	const_iterator begin() const noexcept { return impl->data; }
+	iterator begin() noexcept { return impl->start; }
+	const_iterator begin() const noexcept { return impl->start; }
 	const_iterator cbegin() const noexcept { return begin(); }
 	iterator end() noexcept { return impl->end; }
 	const_iterator end() const noexcept { return impl->end; }
@@ -116,22 +116,26 @@ public:
 	String &operator=(const String &other);
 	String &operator=(String &&other) noexcept;
 
-	intptr_t size() const { return impl->end - impl->data; }
+	intptr_t size() const { return impl->end - impl->start; }
 
 	intptr_t grapheme_count() const;
 
-	intptr_t capacity() const { return impl->limit - impl->data; }
+	intptr_t capacity() const { return impl->limit - impl->start; }
 
-	bool empty() const { return impl->end == impl->data; }
+	bool empty() const { return impl->end == impl->start; }
 
-	const char *data() const { return impl->data; }
+	// Get a null-terminated string. A slice always ends where the buffer it shares ends, so this never needs to copy.
+	const char *data() const { return impl->start; }
 
+	// True if this string shares the buffer of another string.
+	bool is_slice() const { return impl->is_slice(); }
 
 	size_t use_count() const { return impl->use_count(); }
 
-	bool shared() const { return impl->shared(); }
+	// A slice doesn't own its buffer, so it must always be copied before being modified.
+	bool shared() const { return impl->shared() || impl->is_slice(); }
 
-	bool unique() const { return impl->unique(); }
+	bool unique() const { return !shared(); }
 
 	void reserve(intptr_t requested);
 
@@ -249,7 +253,7 @@ public:
 	intptr_t rfind(Substring infix, intptr_t pos = -1) const;
 	const_iterator rfind(Substring infix, const_iterator pos) const;
 
-	Substring view() const { return Substring(data(), size_t(size())); }
+	Substring view() const { return Substring(begin(), size_t(size())); }
 
 	String to_upper() const;
 	String to_lower() const;
@@ -263,10 +267,11 @@ public:
 	static String convert(double n);
 
 	static double to_float(Substring str, bool *ok = nullptr);
-	double to_float(bool *ok = nullptr) const { return to_float(view(), ok); }
+	// The conversion functions need a null-terminated string.
+	double to_float(bool *ok = nullptr) const { return to_float(Substring(data(), size_t(size())), ok); }
 
 	static intptr_t to_int(Substring str, bool *ok = nullptr);
-	intptr_t to_int(bool *ok = nullptr) const { return to_int(view(), ok); }
+	intptr_t to_int(bool *ok = nullptr) const { return to_int(Substring(data(), size_t(size())), ok); }
 
 	static bool to_bool(Substring str, bool strict = false);
 	bool to_bool(bool strict = false) const { return to_bool(view(), strict); }
@@ -299,6 +304,19 @@ public:
 
 	Array<String> split(Substring separator) const;
 
+	// Create a string from a fragment of a larger text, without extra capacity.
+	static String fragment(const char *str, intptr_t len);
+
+	static String fragment(Substring s) { return fragment(s.data(), intptr_t(s.size())); }
+
+	// Create a string from a fragment of this string, which must point into its buffer. A fragment that runs to the end
+	// of the string shares the buffer rather than copying it if it uses a significant part of it, so that a short
+	// substring doesn't keep a large text alive. Other fragments are copied, since a slice must be null-terminated.
+	// Slices are copied when they are modified (see shared()).
+	String slice(const_iterator from, intptr_t len) const;
+
+	String slice(Substring s) const { return slice(s.data(), intptr_t(s.size())); }
+
 	void chop(intptr_t new_size);
 
 	// Replace positional arguments %1 to %9. This is similar to Qt's QString::arg method.
@@ -327,14 +345,20 @@ public:
 private:
 
 	friend class Variant;
+	friend class File;
 
 	struct Data : public Countable<Data,uint32_t>
 	{
 		// Constructor for the empty string
-		Data() : end(data), limit(data + meta::pointer_size) { }
+		Data() : start(data), end(data), limit(data + meta::pointer_size) { }
 
 		Data(const char *str, intptr_t len, intptr_t capacity);
 
+		// Construct a slice of the buffer owned by [parent].
+		Data(Data *parent, const char *str, intptr_t len);
+
+		~Data();
+
 		static void operator delete(void* ptr, size_t);
 
 		static IntrusivePtr <Data> create(intptr_t capacity, bool exact);
@@ -343,31 +367,64 @@ private:
 
 		static IntrusivePtr<Data> create(const char *str, intptr_t len, intptr_t capacity);
 
+		static IntrusivePtr<Data> create_slice(Data *parent, const char *str, intptr_t len);
+
+		bool is_slice() const { return start != data; }
+
 		char32_t next_codepoint(String::const_iterator &it) const;
 
 		char32_t previous_codepoint(String::const_iterator &it) const;
 
 		void reset();
 
+		enum : uint32_t
+		{
+			AsciiUnknown = 0,
+			// All the bytes are ASCII, and there is no "\r\n" sequence: each byte is a grapheme.
+			AsciiSimple  = 1,
+			// All the bytes are ASCII, but the string contains "\r\n", which is a single grapheme.
+			AsciiCrLf    = 2,
+			NonAscii     = 3
+		};
+
 		// Cached length (in user perceived characters).
-		uint32_t length = 0;
+		uint32_t length : 30 = 0;
+
+		// Cached result of the ASCII check.
+		uint32_t ascii : 2 = AsciiUnknown;
 
 		// Cached hash value.
 		size_t hash = 0;
 
-		// Points to the end of the string (i.e. the null terminator).
+		// Points to the first byte of the string: this is [data], unless the string is a slice of another string.
+		char *start;
+
+		// Points to the end of the string (i.e. the null terminator). A slice ends where its parent ends.
 		char *end;
 
-		// Points to the first byte past the end of the allocated buffer.
+		// Points to the first byte past the end of the allocated buffer. A slice has no capacity: limit == start.
 		char *limit;
 
-		// Beginning of the data (more is allocated after that).
-		char data[meta::pointer_size] = { '\0' };
+		union
+		{
+			// Beginning of the data (more is allocated after that).
+			char data[meta::pointer_size] = { '\0' };
+
+			// A slice has no data of its own: it holds a reference to the string that owns its bytes.
+			Data *parent;
+		};
 	};
 
 	// Pointer to implementation.
 	IntrusivePtr<Data> impl;
 
+	// Fragments shorter than this are always copied: a slice needs a header of its own, so sharing a few bytes would
+	// save next to nothing.
+	static constexpr intptr_t MinSliceSize = 32;
+
+	// A slice must use at least 1/MaxSliceWaste of the buffer it shares.
+	static constexpr intptr_t MaxSliceWaste = 4;
+
 	IntrusivePtr<Data> empty_string();
 
 #ifdef PHON_USE_QT
@@ -376,12 +433,21 @@ private:
     { }
 #endif
 
-	char* chars() { return impl->data;  }
+	char* chars() { return impl->start;  }
 
 	bool check_capacity(intptr_t requested) const;
 
+	// Get the ASCII state of the string, scanning it if needed.
+	uint32_t ascii_state() const;
+
+	// True if each byte is a grapheme, in which case grapheme indices are byte indices.
+	bool single_byte_graphemes() const { return ascii_state() == Data::AsciiSimple; }
+
 	void adjust(intptr_t new_size);
 
+	// Apply a byte-level case mapping to an ASCII string.
+	String map_ascii(bool upper) const;
+
 	bool equals(const char *str, size_t len) const;
 
 	static bool grapheme_break(char32_t c1, char32_t c2);
@@ -24,6 +24,9 @@ class Object;
 class String;
 class File;
 class Regex;
+class Match;
+class Matcher;
+class RegexScanner;
 class Variant;
 class Iterator;
 class ListIterator;
@@ -31,6 +34,8 @@ class TableIterator;
 class StringIterator;
 class FileIterator;
 class RegexIterator;
+class Range;
+class RangeIterator;
 template<class T> class Array;
 
 // Dummy base class for Float and Integer
@@ -50,12 +55,16 @@ template<typename T> struct maybe_cyclic : std::true_type
 NON_CYCLIC(String);
 NON_CYCLIC(File);
 NON_CYCLIC(Regex);
+NON_CYCLIC(Match);
+NON_CYCLIC(Matcher);
 NON_CYCLIC(Iterator);
 NON_CYCLIC(ListIterator);
 NON_CYCLIC(TableIterator);
 NON_CYCLIC(StringIterator);
 NON_CYCLIC(FileIterator);
 NON_CYCLIC(RegexIterator);
+NON_CYCLIC(RangeIterator);
+NON_CYCLIC(Range);
 NON_CYCLIC(Array<double>);
 
 #undef NON_CYCLIC
@@ -106,9 +115,9 @@ template<> struct is_safely_movable<String> : std::true_type
 
 };
 
-// FIXME: circumvent error CV2139 with MSVC
-//  "an undefined class is not allowed as an argument to compiler intrinsic type trait 'trait'"
-template<> struct is_safely_movable<Variant> : std::false_type
+// A variant only holds a pointer to its payload and its move constructor is a bitwise copy, so it can be relocated
+// with realloc() when an array grows.
+template<> struct is_safely_movable<Variant> : std::true_type
 {
 
 };
@@ -56,6 +56,16 @@ public:
 
 	~TObject() = default;
 
+	static void *operator new(size_t size)
+	{
+		return Object::allocate(detail::ClassDescriptor<T>::get(), size);
+	}
+
+	static void operator delete(void *ptr, size_t size)
+	{
+		Object::deallocate(detail::ClassDescriptor<T>::get(), ptr, size);
+	}
+
 	T &value()
 	{ return m_value; }
 
@@ -145,6 +145,12 @@ bool Variant::is_object() const
 	return m_data_type == Datatype::Object;
 }
 
+bool Variant::shared() const
+{
+	auto &v = resolve();
+	return v.is_object() && v.as.object->shared();
+}
+
 const std::type_info *Variant::type_info() const
 {
 	switch (m_data_type)
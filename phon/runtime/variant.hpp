@@ -183,6 +183,10 @@ struct Alias final
 
 	~Alias() = default;
 
+	static void *operator new(size_t size) { return utils::alloc(intptr_t(size), utils::MemoryCategory::Aliases); }
+
+	static void operator delete(void *ptr) { utils::free(ptr, utils::MemoryCategory::Aliases); }
+
 	void retain() { ++ref_count; }
 
 	void release()
@@ -102,6 +102,9 @@ public:
 
 	bool is_object() const;
 
+	// Returns true if the variant holds an object which is also referenced elsewhere.
+	bool shared() const;
+
 	bool is_integer() const { return m_data_type == Datatype::Integer; }
 
 	bool is_float() const { return m_data_type == Datatype::Float; }
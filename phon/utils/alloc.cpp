@@ -12,46 +12,191 @@
  *                                                                                                                    *
  **********************************************************************************************************************/
 
+#include <cassert>
 #include <cstring>
+#include <utility>
 #include <phon/utils/alloc.hpp>
 
+#if defined(__APPLE__)
+#	include <malloc/malloc.h>
+#else
+#	include <malloc.h>
+#endif
+
 namespace phonometrica { namespace utils {
 
-void *alloc(intptr_t size)
+static thread_local MemoryTracker *memory_tracker = nullptr;
+
+// Blocks are accounted for by their usable size, which is what they actually cost.
+static intptr_t block_size(void *ptr)
+{
+#if PHON_WINDOWS
+	return intptr_t(_msize(ptr));
+#elif defined(__APPLE__)
+	return intptr_t(malloc_size(ptr));
+#else
+	return intptr_t(malloc_usable_size(ptr));
+#endif
+}
+
+const char *MemoryTracker::get_category_name(MemoryCategory category)
+{
+	switch (category)
+	{
+		case MemoryCategory::Strings: return "strings";
+		case MemoryCategory::Arrays: return "arrays";
+		case MemoryCategory::Tables: return "tables";
+		case MemoryCategory::Objects: return "objects";
+		case MemoryCategory::Aliases: return "aliases";
+		case MemoryCategory::Frames: return "frames";
+		default: return "other";
+	}
+}
+
+static size_t hash_block(void *ptr)
+{
+	// Blocks are at least 16-byte aligned, so the low bits carry no information.
+	return size_t((uintptr_t(ptr) >> 4) * UINT64_C(11400714819323198485));
+}
+
+void BlockTable::insert(void *ptr, intptr_t size, MemoryCategory category)
+{
+	// Keep the load factor under 1/2.
+	if (2 * (m_count + 1) > m_blocks.size()) {
+		grow();
+	}
+	auto i = find(ptr);
+	assert(m_blocks[i].ptr == nullptr);
+	m_blocks[i] = { ptr, size, category };
+	m_count++;
+}
+
+bool BlockTable::remove(void *ptr, Block &block)
+{
+	if (m_count == 0) {
+		return false;
+	}
+	auto i = find(ptr);
+	if (m_blocks[i].ptr == nullptr) {
+		return false;
+	}
+	block = m_blocks[i];
+	m_count--;
+
+	// Shift back the following blocks in the probe sequence so that we don't need tombstones.
+	auto mask = m_blocks.size() - 1;
+	auto j = i;
+
+	while (true)
+	{
+		j = (j + 1) & mask;
+		if (m_blocks[j].ptr == nullptr) {
+			break;
+		}
+		auto k = hash_block(m_blocks[j].ptr) & mask;
+		// Move block j to the hole at i unless its home slot k lies cyclically in (i, j].
+		if ((i < j) ? (k <= i || k > j) : (k <= i && k > j))
+		{
+			m_blocks[i] = m_blocks[j];
+			i = j;
+		}
+	}
+	m_blocks[i].ptr = nullptr;
+
+	return true;
+}
+
+bool BlockTable::contains(void *ptr) const
+{
+	return m_count > 0 && m_blocks[find(ptr)].ptr != nullptr;
+}
+
+size_t BlockTable::find(void *ptr) const
+{
+	auto mask = m_blocks.size() - 1;
+	auto i = hash_block(ptr) & mask;
+
+	while (m_blocks[i].ptr && m_blocks[i].ptr != ptr) {
+		i = (i + 1) & mask;
+	}
+
+	return i;
+}
+
+void BlockTable::grow()
+{
+	std::vector<Block> blocks(m_blocks.empty() ? 1024 : m_blocks.size() * 2, Block{ nullptr, 0, MemoryCategory::Other });
+	std::swap(blocks, m_blocks);
+
+	for (auto &b : blocks)
+	{
+		if (b.ptr) {
+			m_blocks[find(b.ptr)] = b;
+		}
+	}
+}
+
+MemoryTracker *get_memory_tracker()
+{
+	return memory_tracker;
+}
+
+MemoryTracker *set_memory_tracker(MemoryTracker *tracker)
+{
+	return std::exchange(memory_tracker, tracker);
+}
+
+void *alloc(intptr_t size, MemoryCategory category)
 {
 	void *ptr = std::malloc((size_t) size);
 
 	if (!ptr) {
 		throw std::bad_alloc();
 	}
+	if (memory_tracker) {
+		memory_tracker->add(ptr, block_size(ptr), category);
+	}
 
 	return ptr;
 }
 
-void *calloc(intptr_t count, intptr_t size)
+void *calloc(intptr_t count, intptr_t size, MemoryCategory category)
 {
 	void *ptr = std::calloc(size_t(count), size_t(size));
 
 	if (!ptr) {
 		throw std::bad_alloc();
 	}
+	if (memory_tracker) {
+		memory_tracker->add(ptr, block_size(ptr), category);
+	}
 
 	return ptr;
 }
 
-void *realloc(void *ptr, intptr_t size)
+void *realloc(void *ptr, intptr_t size, MemoryCategory category)
 {
+	// If reallocation fails, the old block is no longer accounted for, which is harmless.
+	if (memory_tracker && ptr) {
+		memory_tracker->remove(ptr);
+	}
 	void *new_ptr = std::realloc(ptr, (size_t) size);
 
 	if (!new_ptr) {
 		throw std::bad_alloc();
 	}
+	if (memory_tracker) {
+		memory_tracker->add(new_ptr, block_size(new_ptr), category);
+	}
 
 	return new_ptr;
 }
 
-void free(void *ptr)
+void free(void *ptr, MemoryCategory)
 {
+	if (memory_tracker && ptr) {
+		memory_tracker->remove(ptr);
+	}
 	std::free(ptr);
 }
 
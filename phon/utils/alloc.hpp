@@ -18,33 +18,173 @@
 #include <cstddef>
 #include <stdexcept>
 #include <algorithm>
+#include <vector>
 #include <phon/runtime/traits.hpp>
 
 namespace phonometrica { namespace utils {
 
+// Categories used to account for memory usage. Tables refers to the storage of all hash maps, not only those of Table objects.
+enum class MemoryCategory
+{
+	Strings,
+	Arrays,
+	Tables,
+	Objects,
+	Aliases,
+	Frames,
+	Other
+};
+
+static constexpr size_t MEMORY_CATEGORY_COUNT = size_t(MemoryCategory::Other) + 1;
+
+// Number of blocks and bytes allocated for a category of memory.
+struct MemoryUsage
+{
+	// Blocks allocated since accounting started.
+	intptr_t allocations = 0;
+	intptr_t allocated_bytes = 0;
+
+	// Blocks currently in use.
+	intptr_t blocks = 0;
+	intptr_t bytes = 0;
+
+	void add(intptr_t size)
+	{
+		allocations++;
+		allocated_bytes += size;
+		blocks++;
+		bytes += size;
+	}
+
+	void remove(intptr_t size)
+	{
+		blocks--;
+		bytes -= size;
+	}
+};
+
+// Blocks accounted for by a tracker, indexed by address. This is an open-addressing hash table with linear probing.
+class BlockTable final
+{
+public:
+
+	struct Block
+	{
+		void *ptr;
+		intptr_t size;
+		MemoryCategory category;
+	};
+
+	void insert(void *ptr, intptr_t size, MemoryCategory category);
+
+	// Remove a block from the table and copy it to `block`. Returns false if the block is not in the table.
+	bool remove(void *ptr, Block &block);
+
+	bool contains(void *ptr) const;
+
+private:
+
+	size_t find(void *ptr) const;
+
+	void grow();
+
+	// Empty slots have a null pointer. The table's capacity is a power of 2.
+	std::vector<Block> m_blocks;
+
+	size_t m_count = 0;
+};
+
+// Memory accounting for all the blocks allocated through this module. When a tracker is installed, the number of
+// blocks and bytes in use is recorded for each category, along with the peak usage. A tracker may also have a soft limit:
+// allocations never fail because of it, but clients can check whether it has been exceeded at a convenient time.
+class MemoryTracker final
+{
+public:
+
+	void add(void *ptr, intptr_t size, MemoryCategory category)
+	{
+		m_blocks.insert(ptr, size, category);
+		m_usage[size_t(category)].add(size);
+		m_total.add(size);
+		m_peak = (std::max)(m_peak, m_total.bytes);
+	}
+
+	// Blocks that were not allocated while this tracker was installed are ignored. Returns true if the block was removed.
+	bool remove(void *ptr)
+	{
+		BlockTable::Block block;
+
+		if (!m_blocks.remove(ptr, block)) {
+			return false;
+		}
+		m_usage[size_t(block.category)].remove(block.size);
+		m_total.remove(block.size);
+
+		return true;
+	}
+
+	// Check whether a block was allocated while this tracker was installed and is still in use.
+	bool accounts_for(void *ptr) const { return m_blocks.contains(ptr); }
+
+	const MemoryUsage &usage(MemoryCategory category) const { return m_usage[size_t(category)]; }
+
+	const MemoryUsage &total() const { return m_total; }
+
+	intptr_t peak() const { return m_peak; }
+
+	intptr_t limit() const { return m_limit; }
+
+	// Set the soft limit in bytes, or 0 for no limit.
+	void set_limit(intptr_t value) { m_limit = value; }
+
+	bool over_limit() const { return m_limit > 0 && m_total.bytes > m_limit; }
+
+	static const char *get_category_name(MemoryCategory category);
+
+private:
+
+	BlockTable m_blocks;
+
+	MemoryUsage m_usage[MEMORY_CATEGORY_COUNT];
+
+	MemoryUsage m_total;
+
+	intptr_t m_peak = 0;
+
+	intptr_t m_limit = 0;
+};
+
+// Get the tracker for the current thread, or null if memory is not being accounted for.
+MemoryTracker *get_memory_tracker();
+
+// Install a tracker for the current thread (null disables accounting) and return the previous one. A block is accounted
+// for by the tracker that was installed when it was allocated, and is only removed from it when it is freed by the same
+// thread while that tracker is still installed.
+MemoryTracker *set_memory_tracker(MemoryTracker *tracker);
+
 // Allocate a block of uninitialized memory.
-void *alloc(intptr_t size);
+void *alloc(intptr_t size, MemoryCategory category = MemoryCategory::Other);
 
 // Allocate a block of zero-initialized memory.
-void *calloc(intptr_t count, intptr_t size);
+void *calloc(intptr_t count, intptr_t size, MemoryCategory category = MemoryCategory::Other);
 
 // Reallocate a block of memory.
-void *realloc(void *ptr, intptr_t size);
+void *realloc(void *ptr, intptr_t size, MemoryCategory category = MemoryCategory::Other);
 
-// Free a block of memory.
-void free(void *ptr);
+// Free a block of memory. The category must be the one the block was allocated with.
+void free(void *ptr, MemoryCategory category = MemoryCategory::Other);
 
 
 // Allocate a 0-initialized array of `size` items.
 template<typename T>
-T *allocate(intptr_t size)
+T *allocate(intptr_t size, MemoryCategory category = MemoryCategory::Other)
 {
-	return reinterpret_cast<T*>(calloc(size, sizeof(T)));
+	return reinterpret_cast<T*>(calloc(size, sizeof(T), category));
 }
 
 // Reallocate array of items, ensuring that the remaining space is 0 allocated.
 template<typename T>
-T *reallocate(T *data, intptr_t count, intptr_t capacity)
+T *reallocate(T *data, intptr_t count, intptr_t capacity, MemoryCategory category = MemoryCategory::Other)
 {
 	T *new_data;
 
@@ -52,16 +192,16 @@ T *reallocate(T *data, intptr_t count, intptr_t capacity)
 	{
 		size_t count_nbytes = count * sizeof(T);
 		size_t capacity_nbytes = capacity * sizeof(T);
-		new_data = reinterpret_cast<T*>(realloc(data, capacity_nbytes));
+		new_data = reinterpret_cast<T*>(realloc(data, capacity_nbytes, category));
 		auto start = reinterpret_cast<std::byte*>(new_data) + count_nbytes;
 		auto end = reinterpret_cast<std::byte*>(new_data) + capacity_nbytes;
 		std::fill(start, end, std::byte{0});
 	}
 	else
 	{
-		new_data = reinterpret_cast<T*>(utils::calloc(capacity, sizeof(T)));
+		new_data = reinterpret_cast<T*>(utils::calloc(capacity, sizeof(T), category));
 		std::move(data, data + count, new_data);
-		utils::free(data);
+		utils::free(data, category);
 	}
 
 	return new_data;
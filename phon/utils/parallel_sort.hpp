@@ -0,0 +1,83 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: multi-threaded sort for large random-access sequences.                                                    *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef PHONOMETRICA_PARALLEL_SORT_HPP
+#define PHONOMETRICA_PARALLEL_SORT_HPP
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace phonometrica { namespace utils {
+
+// Below this number of elements, sequences are always sorted in the calling thread.
+static constexpr intptr_t parallel_sort_threshold = 50000;
+
+// Sort the range [first, last). The sequence is split into contiguous chunks which are sorted concurrently, and
+// neighbouring chunks are then merged pairwise, also concurrently. Merging preserves the relative order of chunks, so
+// the result is stable if `stable` is true. The comparison function must be safe to call from several threads at once.
+template<class RandomIt, class Compare>
+void parallel_sort(RandomIt first, RandomIt last, Compare comp, bool stable = false)
+{
+	auto sort_range = [=](RandomIt from, RandomIt to) {
+		if (stable) std::stable_sort(from, to, comp); else std::sort(from, to, comp);
+	};
+
+	intptr_t size = intptr_t(last - first);
+	intptr_t nthread = std::thread::hardware_concurrency();
+	nthread = (std::min)(nthread, size / (parallel_sort_threshold / 2));
+
+	if (size < parallel_sort_threshold || nthread < 2)
+	{
+		sort_range(first, last);
+		return;
+	}
+
+	// Chunk boundaries: chunk i is [bounds[i], bounds[i+1]).
+	std::vector<RandomIt> bounds;
+	intptr_t chunk_size = size / nthread;
+	for (intptr_t i = 0; i < nthread; i++) {
+		bounds.push_back(first + i * chunk_size);
+	}
+	bounds.push_back(last);
+
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i + 1 < bounds.size(); i++) {
+		workers.emplace_back(sort_range, bounds[i], bounds[i+1]);
+	}
+	for (auto &w : workers) w.join();
+
+	// Merge neighbouring chunks until there is only one left.
+	while (bounds.size() > 2)
+	{
+		std::vector<RandomIt> merged;
+		workers.clear();
+
+		for (size_t i = 0; i + 1 < bounds.size(); i += 2)
+		{
+			merged.push_back(bounds[i]);
+			if (i + 2 < bounds.size()) {
+				auto from = bounds[i], middle = bounds[i+1], to = bounds[i+2];
+				workers.emplace_back([=]() { std::inplace_merge(from, middle, to, comp); });
+			}
+		}
+		merged.push_back(last);
+		for (auto &w : workers) w.join();
+		bounds = std::move(merged);
+	}
+}
+
+}} // namespace phonometrica::utils
+
+#endif // PHONOMETRICA_PARALLEL_SORT_HPP
@@ -0,0 +1,159 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: see header.                                                                                               *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+
+#include <cstring>
+#include <phon/utils/string_search.hpp>
+
+#if defined(_MSC_VER)
+#	include <intrin.h>
+#endif
+
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#	include <emmintrin.h>
+#	define PHON_SEARCH_SSE2 1
+#endif
+
+namespace phonometrica { namespace utils {
+
+static inline int first_bit(unsigned mask)
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return int(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+
+const char *find_substring(const char *haystack, size_t n, const char *needle, size_t m)
+{
+	if (m == 0) {
+		return haystack;
+	}
+	if (m > n) {
+		return nullptr;
+	}
+	if (m == 1) {
+		return static_cast<const char*>(memchr(haystack, needle[0], n));
+	}
+
+	size_t i = 0;
+	const char first = needle[0];
+	const char last = needle[m - 1];
+
+#if defined(__AVX2__)
+	const __m256i vfirst = _mm256_set1_epi8(first);
+	const __m256i vlast = _mm256_set1_epi8(last);
+
+	for (; i + m + 31 <= n; i += 32)
+	{
+		auto block_first = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i));
+		auto block_last = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(haystack + i + m - 1));
+		auto eq = _mm256_and_si256(_mm256_cmpeq_epi8(vfirst, block_first), _mm256_cmpeq_epi8(vlast, block_last));
+		auto mask = unsigned(_mm256_movemask_epi8(eq));
+
+		while (mask)
+		{
+			auto pos = i + size_t(first_bit(mask));
+			if (memcmp(haystack + pos + 1, needle + 1, m - 2) == 0) {
+				return haystack + pos;
+			}
+			mask &= mask - 1;
+		}
+	}
+#elif defined(PHON_SEARCH_SSE2)
+	const __m128i vfirst = _mm_set1_epi8(first);
+	const __m128i vlast = _mm_set1_epi8(last);
+
+	for (; i + m + 15 <= n; i += 16)
+	{
+		auto block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i));
+		auto block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(haystack + i + m - 1));
+		auto eq = _mm_and_si128(_mm_cmpeq_epi8(vfirst, block_first), _mm_cmpeq_epi8(vlast, block_last));
+		auto mask = unsigned(_mm_movemask_epi8(eq));
+
+		while (mask)
+		{
+			auto pos = i + size_t(first_bit(mask));
+			if (memcmp(haystack + pos + 1, needle + 1, m - 2) == 0) {
+				return haystack + pos;
+			}
+			mask &= mask - 1;
+		}
+	}
+#endif
+
+	// Remaining positions (or all of them if SIMD is not available): jump from one occurrence of the first byte
+	// to the next.
+	while (i + m <= n)
+	{
+		auto p = static_cast<const char*>(memchr(haystack + i, first, n - m + 1 - i));
+		if (!p) break;
+		i = size_t(p - haystack);
+
+		if (haystack[i + m - 1] == last && memcmp(haystack + i + 1, needle + 1, m - 2) == 0) {
+			return p;
+		}
+		i++;
+	}
+
+	return nullptr;
+}
+
+size_t count_substring(const char *haystack, size_t n, const char *needle, size_t m)
+{
+	size_t total = 0;
+	auto end = haystack + n;
+	const char *p;
+
+	while ((p = find_substring(haystack, size_t(end - haystack), needle, m)) != nullptr)
+	{
+		total++;
+		haystack = p + m;
+	}
+
+	return total;
+}
+
+bool is_ascii(const char *text, size_t n)
+{
+	size_t i = 0;
+
+#if defined(__AVX2__)
+	for (; i + 32 <= n; i += 32)
+	{
+		auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + i));
+		if (_mm256_movemask_epi8(block) != 0) return false;
+	}
+#elif defined(PHON_SEARCH_SSE2)
+	for (; i + 16 <= n; i += 16)
+	{
+		auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + i));
+		if (_mm_movemask_epi8(block) != 0) return false;
+	}
+#endif
+
+	for (; i < n; i++)
+	{
+		if (static_cast<unsigned char>(text[i]) & 0x80) return false;
+	}
+
+	return true;
+}
+
+}} // namespace phonometrica::utils
@@ -0,0 +1,39 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: Fast byte-level text scanning.                                                                            *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+
+#ifndef PHONOMETRICA_STRING_SEARCH_HPP
+#define PHONOMETRICA_STRING_SEARCH_HPP
+
+#include <cstddef>
+
+// Substring search shared by the String class. Candidate positions are found by comparing the first and last bytes
+// of the needle against a block of 16 bytes (SSE2) or 32 bytes (AVX2, see PHON_USE_AVX2 in CMakeLists.txt) of the
+// haystack at once, and only the candidates are checked with memcmp. Single-byte needles use memchr.
+
+namespace phonometrica { namespace utils {
+
+// Find the first occurrence of needle in haystack. Returns a pointer to the match, or nullptr if there is none. An
+// empty needle matches at the beginning of the haystack.
+const char *find_substring(const char *haystack, size_t n, const char *needle, size_t m);
+
+// Count the non-overlapping occurrences of needle in haystack. The needle must not be empty.
+size_t count_substring(const char *haystack, size_t n, const char *needle, size_t m);
+
+// Check whether all the bytes in the text are ASCII.
+bool is_ascii(const char *text, size_t n);
+
+}} // namespace phonometrica::utils
+
+#endif // PHONOMETRICA_STRING_SEARCH_HPP
@@ -0,0 +1,372 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: see header.                                                                                               *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include <cmath>
+#include <cassert>
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <phon/utils/vector_math.hpp>
+
+#if defined(__AVX2__)
+#	include <immintrin.h>
+#	define PHON_AVX2 1
+#else
+#	define PHON_AVX2 0
+#endif
+
+namespace phonometrica { namespace utils {
+
+namespace {
+
+struct Add
+{
+	static double apply(double x, double y) { return x + y; }
+#if PHON_AVX2
+	static __m256d apply(__m256d x, __m256d y) { return _mm256_add_pd(x, y); }
+#endif
+};
+
+struct Sub
+{
+	static double apply(double x, double y) { return x - y; }
+#if PHON_AVX2
+	static __m256d apply(__m256d x, __m256d y) { return _mm256_sub_pd(x, y); }
+#endif
+};
+
+struct Mul
+{
+	static double apply(double x, double y) { return x * y; }
+#if PHON_AVX2
+	static __m256d apply(__m256d x, __m256d y) { return _mm256_mul_pd(x, y); }
+#endif
+};
+
+struct Div
+{
+	static double apply(double x, double y) { return x / y; }
+#if PHON_AVX2
+	static __m256d apply(__m256d x, __m256d y) { return _mm256_div_pd(x, y); }
+#endif
+};
+
+#if PHON_AVX2
+double horizontal_sum(__m256d v)
+{
+	__m128d lo = _mm256_castpd256_pd128(v);
+	__m128d hi = _mm256_extractf128_pd(v, 1);
+	lo = _mm_add_pd(lo, hi);
+	__m128d shuf = _mm_unpackhi_pd(lo, lo);
+
+	return _mm_cvtsd_f64(_mm_add_sd(lo, shuf));
+}
+#endif
+
+template<class Op>
+void apply_op(const double *x, const double *y, double *out, intptr_t n)
+{
+	intptr_t i = 0;
+#if PHON_AVX2
+	for (; i + 4 <= n; i += 4) {
+		_mm256_storeu_pd(out + i, Op::apply(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+	}
+#endif
+	for (; i < n; i++) {
+		out[i] = Op::apply(x[i], y[i]);
+	}
+}
+
+template<class Op>
+void apply_op(const double *x, double y, double *out, intptr_t n)
+{
+	intptr_t i = 0;
+#if PHON_AVX2
+	__m256d yy = _mm256_set1_pd(y);
+	for (; i + 4 <= n; i += 4) {
+		_mm256_storeu_pd(out + i, Op::apply(_mm256_loadu_pd(x + i), yy));
+	}
+#endif
+	for (; i < n; i++) {
+		out[i] = Op::apply(x[i], y);
+	}
+}
+
+template<class Op>
+void apply_op(double x, const double *y, double *out, intptr_t n)
+{
+	intptr_t i = 0;
+#if PHON_AVX2
+	__m256d xx = _mm256_set1_pd(x);
+	for (; i + 4 <= n; i += 4) {
+		_mm256_storeu_pd(out + i, Op::apply(xx, _mm256_loadu_pd(y + i)));
+	}
+#endif
+	for (; i < n; i++) {
+		out[i] = Op::apply(x, y[i]);
+	}
+}
+
+template<class X, class Y>
+void dispatch_op(char op, X x, Y y, double *out, intptr_t n)
+{
+	switch (op)
+	{
+		case '+':
+			apply_op<Add>(x, y, out, n);
+			break;
+		case '-':
+			apply_op<Sub>(x, y, out, n);
+			break;
+		case '*':
+			apply_op<Mul>(x, y, out, n);
+			break;
+		case '/':
+			apply_op<Div>(x, y, out, n);
+			break;
+		default:
+			assert(false);
+	}
+}
+
+template<class Compare>
+intptr_t find_extremum(const double *x, intptr_t n, Compare better)
+{
+	intptr_t pos = -1;
+
+	for (intptr_t i = 0; i < n; i++)
+	{
+		if (std::isnan(x[i])) continue;
+		if (pos < 0 || better(x[i], x[pos])) pos = i;
+	}
+
+	return pos;
+}
+
+// Compute columns [from, to) of c = a * b. The loops are tiled so that a block of a stays in cache while it is being
+// reused across the columns of b. The innermost loop runs down contiguous columns of a and c.
+void multiply_columns(const double *a, const double *b, double *c, intptr_t m, intptr_t k, intptr_t from, intptr_t to)
+{
+	const intptr_t block_size = 128;
+
+	for (intptr_t kk = 0; kk < k; kk += block_size)
+	{
+		intptr_t k_end = (std::min)(kk + block_size, k);
+
+		for (intptr_t ii = 0; ii < m; ii += block_size)
+		{
+			intptr_t i_end = (std::min)(ii + block_size, m);
+
+			for (intptr_t j = from; j < to; j++)
+			{
+				double *cj = c + j * m;
+				const double *bj = b + j * k;
+
+				for (intptr_t p = kk; p < k_end; p++)
+				{
+					const double *ap = a + p * m;
+					double bpj = bj[p];
+					for (intptr_t i = ii; i < i_end; i++) {
+						cj[i] += ap[i] * bpj;
+					}
+				}
+			}
+		}
+	}
+}
+
+} // namespace
+
+double vector_sum(const double *x, intptr_t n)
+{
+	intptr_t i = 0;
+	double total = 0;
+#if PHON_AVX2
+	__m256d acc1 = _mm256_setzero_pd(), acc2 = _mm256_setzero_pd();
+	for (; i + 8 <= n; i += 8)
+	{
+		acc1 = _mm256_add_pd(acc1, _mm256_loadu_pd(x + i));
+		acc2 = _mm256_add_pd(acc2, _mm256_loadu_pd(x + i + 4));
+	}
+	total = horizontal_sum(_mm256_add_pd(acc1, acc2));
+#else
+	// Independent accumulators break the dependency chain between additions.
+	double acc[4] = { 0, 0, 0, 0 };
+	for (; i + 4 <= n; i += 4)
+	{
+		acc[0] += x[i];
+		acc[1] += x[i+1];
+		acc[2] += x[i+2];
+		acc[3] += x[i+3];
+	}
+	total = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+	for (; i < n; i++) {
+		total += x[i];
+	}
+
+	return total;
+}
+
+double vector_sum_squares(const double *x, intptr_t n, double center)
+{
+	intptr_t i = 0;
+	double total = 0;
+#if PHON_AVX2
+	__m256d acc = _mm256_setzero_pd();
+	__m256d c = _mm256_set1_pd(center);
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d d = _mm256_sub_pd(_mm256_loadu_pd(x + i), c);
+		acc = _mm256_add_pd(acc, _mm256_mul_pd(d, d));
+	}
+	total = horizontal_sum(acc);
+#endif
+	for (; i < n; i++)
+	{
+		double d = x[i] - center;
+		total += d * d;
+	}
+
+	return total;
+}
+
+double vector_dot(const double *x, const double *y, intptr_t n)
+{
+	intptr_t i = 0;
+	double total = 0;
+#if PHON_AVX2
+	__m256d acc1 = _mm256_setzero_pd(), acc2 = _mm256_setzero_pd();
+	for (; i + 8 <= n; i += 8)
+	{
+		acc1 = _mm256_add_pd(acc1, _mm256_mul_pd(_mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+		acc2 = _mm256_add_pd(acc2, _mm256_mul_pd(_mm256_loadu_pd(x + i + 4), _mm256_loadu_pd(y + i + 4)));
+	}
+	total = horizontal_sum(_mm256_add_pd(acc1, acc2));
+#else
+	double acc[4] = { 0, 0, 0, 0 };
+	for (; i + 4 <= n; i += 4)
+	{
+		acc[0] += x[i] * y[i];
+		acc[1] += x[i+1] * y[i+1];
+		acc[2] += x[i+2] * y[i+2];
+		acc[3] += x[i+3] * y[i+3];
+	}
+	total = (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+	for (; i < n; i++) {
+		total += x[i] * y[i];
+	}
+
+	return total;
+}
+
+intptr_t vector_argmin(const double *x, intptr_t n)
+{
+	return find_extremum(x, n, [](double a, double b) { return a < b; });
+}
+
+intptr_t vector_argmax(const double *x, intptr_t n)
+{
+	return find_extremum(x, n, [](double a, double b) { return a > b; });
+}
+
+void vector_op(char op, const double *x, const double *y, double *out, intptr_t n)
+{
+	dispatch_op(op, x, y, out, n);
+}
+
+void vector_op(char op, const double *x, double y, double *out, intptr_t n)
+{
+	dispatch_op(op, x, y, out, n);
+}
+
+void vector_op(char op, double x, const double *y, double *out, intptr_t n)
+{
+	dispatch_op(op, x, y, out, n);
+}
+
+void vector_sqrt(const double *x, double *out, intptr_t n)
+{
+	intptr_t i = 0;
+#if PHON_AVX2
+	for (; i + 4 <= n; i += 4) {
+		_mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_loadu_pd(x + i)));
+	}
+#endif
+	for (; i < n; i++) {
+		out[i] = std::sqrt(x[i]);
+	}
+}
+
+void vector_cumsum(const double *x, double *out, intptr_t n)
+{
+	double total = 0;
+
+	for (intptr_t i = 0; i < n; i++)
+	{
+		total += x[i];
+		out[i] = total;
+	}
+}
+
+void matrix_multiply(const double *a, const double *b, double *c, intptr_t m, intptr_t k, intptr_t n)
+{
+	// Don't bother with threads for small matrices.
+	const double min_work = 1 << 21;
+	intptr_t nthread = std::thread::hardware_concurrency();
+	nthread = (std::min)(nthread, n);
+
+	if (nthread < 2 || double(m) * double(k) * double(n) < min_work)
+	{
+		multiply_columns(a, b, c, m, k, 0, n);
+		return;
+	}
+
+	// Each thread computes a contiguous range of columns in c.
+	std::vector<std::thread> workers;
+	intptr_t chunk_size = (n + nthread - 1) / nthread;
+
+	for (intptr_t from = 0; from < n; from += chunk_size)
+	{
+		intptr_t to = (std::min)(from + chunk_size, n);
+		workers.emplace_back(multiply_columns, a, b, c, m, k, from, to);
+	}
+	for (auto &w : workers) w.join();
+}
+
+void matrix_transpose(const double *x, double *out, intptr_t nrow, intptr_t ncol)
+{
+	// Transpose tile by tile to limit cache misses on the strided side.
+	const intptr_t tile_size = 32;
+
+	for (intptr_t jj = 0; jj < ncol; jj += tile_size)
+	{
+		intptr_t j_end = (std::min)(jj + tile_size, ncol);
+
+		for (intptr_t ii = 0; ii < nrow; ii += tile_size)
+		{
+			intptr_t i_end = (std::min)(ii + tile_size, nrow);
+
+			for (intptr_t j = jj; j < j_end; j++)
+			{
+				for (intptr_t i = ii; i < i_end; i++) {
+					out[i * ncol + j] = x[j * nrow + i];
+				}
+			}
+		}
+	}
+}
+
+}} // namespace phonometrica::utils
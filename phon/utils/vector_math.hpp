@@ -0,0 +1,62 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: vectorized kernels for arrays of floating point numbers.                                                  *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef PHONOMETRICA_VECTOR_MATH_HPP
+#define PHONOMETRICA_VECTOR_MATH_HPP
+
+#include <cstdint>
+
+// All the kernels below operate on contiguous (0-based) blocks of n doubles. Input and output buffers may be identical
+// but must not otherwise overlap. If the library is compiled with AVX2 support (see PHON_USE_AVX2 in CMakeLists.txt),
+// the kernels process 4 values at a time; otherwise, they fall back to plain loops which the compiler may vectorize.
+
+namespace phonometrica { namespace utils {
+
+double vector_sum(const double *x, intptr_t n);
+
+// Sum of squared deviations from a given value (used to compute the variance).
+double vector_sum_squares(const double *x, intptr_t n, double center);
+
+double vector_dot(const double *x, const double *y, intptr_t n);
+
+// Position of the smallest/largest value, or -1 if n == 0. NaN values are ignored.
+intptr_t vector_argmin(const double *x, intptr_t n);
+
+intptr_t vector_argmax(const double *x, intptr_t n);
+
+// Element-wise operations. op must be one of '+', '-', '*' or '/'.
+void vector_op(char op, const double *x, const double *y, double *out, intptr_t n);
+
+// x op scalar
+void vector_op(char op, const double *x, double y, double *out, intptr_t n);
+
+// scalar op y
+void vector_op(char op, double x, const double *y, double *out, intptr_t n);
+
+void vector_sqrt(const double *x, double *out, intptr_t n);
+
+void vector_cumsum(const double *x, double *out, intptr_t n);
+
+// Matrices are stored in column-major order, like Array<T>.
+
+// Compute c = a * b, where a is an m x k matrix and b is a k x n matrix. c must be zero-initialized and must not overlap
+// with the input. Large products are computed in parallel.
+void matrix_multiply(const double *a, const double *b, double *c, intptr_t m, intptr_t k, intptr_t n);
+
+// Write the transpose of the nrow x ncol matrix x to out, which must not overlap with x.
+void matrix_transpose(const double *x, double *out, intptr_t nrow, intptr_t ncol);
+
+}} // namespace phonometrica::utils
+
+#endif // PHONOMETRICA_VECTOR_MATH_HPP
@@ -0,0 +1,53 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: entry point of the unit tests.                                                                            *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "unit_test.hpp"
+
+namespace phonometrica {
+
+int failures = 0;
+
+std::string run(Runtime &rt, const std::string &code)
+{
+	try
+	{
+		rt.do_string(String(code));
+	}
+	catch (std::exception &e)
+	{
+		return e.what();
+	}
+
+	return std::string();
+}
+
+} // namespace phonometrica
+
+using namespace phonometrica;
+
+int main()
+{
+	Runtime rt;
+	test_budget(rt);
+	test_large_scripts(rt);
+
+	if (failures > 0)
+	{
+		fprintf(stderr, "%d check(s) failed\n", failures);
+		return 1;
+	}
+	printf("all unit tests passed\n");
+
+	return 0;
+}
@@ -0,0 +1,97 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: check the execution budget of the runtime: step limit, time limit and interruption. These can only be     *
+ * set by the host, so they are tested from C++ rather than from a script.                                            *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include <chrono>
+#include <thread>
+#include "unit_test.hpp"
+
+using namespace std::chrono_literals;
+
+namespace phonometrica {
+
+static const char *endless_loop = "while true do\nend\n";
+
+static const char *short_loop = "local n = 0\nforeach i in range(1, 100) do\n n = n + i\nend\nassert n == 5050\n";
+
+// Scripts can't catch errors raised because the budget is exhausted. Functions are global and can't be redefined, so
+// each run uses a different name.
+static std::string endless_catch(const char *name)
+{
+	std::string f(name);
+	return "function " + f + "()\n while true do\n end\nend\nwhile true do\n catch_error(" + f + ")\nend\n";
+}
+
+static void test_step_limit(Runtime &rt)
+{
+	rt.set_step_limit(10000);
+	CHECK(starts_with(run(rt, endless_loop), "[Limit error] Script exceeded the limit of 10000 steps"));
+
+	// Each run gets a new budget.
+	CHECK(run(rt, short_loop).empty());
+	CHECK(starts_with(run(rt, endless_catch("spin1")), "[Limit error]"));
+
+	rt.set_step_limit(0);
+	CHECK(run(rt, short_loop).empty());
+}
+
+static void test_time_limit(Runtime &rt)
+{
+	rt.set_time_limit(50ms);
+	auto start = std::chrono::steady_clock::now();
+	CHECK(starts_with(run(rt, endless_loop), "[Limit error] Script exceeded the time limit of 50 ms"));
+	CHECK(std::chrono::steady_clock::now() - start < 10s);
+
+	CHECK(run(rt, short_loop).empty());
+	CHECK(starts_with(run(rt, endless_catch("spin2")), "[Limit error]"));
+
+	rt.set_time_limit(0ms);
+	CHECK(run(rt, short_loop).empty());
+}
+
+static void test_interrupt(Runtime &rt)
+{
+	// From another thread, while the script is running.
+	std::thread thread([&rt]() {
+		std::this_thread::sleep_for(50ms);
+		rt.interrupt();
+	});
+	CHECK(starts_with(run(rt, endless_loop), "[Interrupt error] Execution was interrupted"));
+	thread.join();
+
+	// A request made before the script starts (e.g. while it is being compiled) is not lost...
+	rt.interrupt();
+	CHECK(starts_with(run(rt, endless_loop), "[Interrupt error]"));
+
+	// ... but it doesn't outlive the run it stopped.
+	CHECK(run(rt, short_loop).empty());
+
+	// A request made before a script that fails to compile is discarded with it.
+	rt.interrupt();
+	CHECK(!starts_with(run(rt, "while while"), "[Interrupt error]"));
+	CHECK(run(rt, short_loop).empty());
+
+	rt.interrupt();
+	CHECK(starts_with(run(rt, endless_catch("spin3")), "[Interrupt error]"));
+	CHECK(run(rt, short_loop).empty());
+}
+
+void test_budget(Runtime &rt)
+{
+	test_step_limit(rt);
+	test_time_limit(rt);
+	test_interrupt(rt);
+}
+
+} // namespace phonometrica
@@ -0,0 +1,101 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: check scripts that exceed the 16-bit limits of the bytecode. They are generated here rather than stored   *
+ * in the tests directory, since they are several megabytes long.                                                     *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#include "unit_test.hpp"
+
+namespace phonometrica {
+
+// More than 65,535 constants of each kind in a single routine, so that the last ones need a Wide prefix.
+static void test_many_constants(Runtime &rt)
+{
+	const int count = 66000;
+	std::string code;
+
+	for (int i = 0; i < count; i++)
+	{
+		auto n = std::to_string(i);
+		code += "var n" + n + " = " + std::to_string(100000 + i) + "\n";
+		code += "var f" + n + " = " + n + ".5\n";
+		code += "var s" + n + " = \"s" + n + "\"\n";
+		code += "function c" + n + "() return " + n + " end\n";
+	}
+
+	// PushInteger, PushFloat, PushString, GetGlobal and NewClosure.
+	code += "assert n0 == 100000\n";
+	code += "assert n65999 == 165999\n";
+	code += "assert f65999 == 65999.5\n";
+	code += "assert s65999 == \"s65999\"\n";
+	code += "assert c65999() == 65999\n";
+
+	// SetGlobal and new constants at the end of the pools.
+	code += "n65999 = n65999 + 1\n";
+	code += "assert n65999 == 166000\n";
+	code += "local late = \"a string defined late\"\n";
+	code += "assert late == \"a string \" & \"defined late\"\n";
+
+	// Float constants are identified by their bits, so 0.0 and -0.0 must remain distinct.
+	code += "local pos = 0.0\n";
+	code += "local neg = -0.0\n";
+	code += "assert pos == neg\n";
+	code += "assert str(pos) != str(neg)\n";
+	code += "assert starts_with(str(neg), \"-\")\n";
+
+	CHECK(run(rt, code).empty());
+}
+
+// More than 65,535 lines: errors raised near the end of the script must report the right line.
+static void test_many_lines(Runtime &rt)
+{
+	const int count = 70000;
+	std::string code = "var total = 0\n";
+
+	for (int i = 0; i < count; i++) {
+		code += "total = total + 1\n";
+	}
+
+	int line = count + 1; // line of the assertion below
+	code += "assert total == " + std::to_string(count) + "\n";
+	code += "function fail_late()\n";
+	code += "\treturn total + \"!\"\n";
+	code += "end\n";
+	code += "var late_error = catch_error(fail_late)\n";
+	code += "assert late_error[\"line\"] == " + std::to_string(line + 2) + "\n";
+	code += "total = total + \"!\"\n";
+
+	intptr_t error_line = 0;
+
+	try
+	{
+		rt.do_string(String(code));
+	}
+	catch (RuntimeError &e)
+	{
+		error_line = e.line_no();
+	}
+	catch (std::exception &)
+	{
+		// Not a runtime error: the check below fails.
+	}
+
+	CHECK(error_line == line + 6);
+}
+
+void test_large_scripts(Runtime &rt)
+{
+	test_many_constants(rt);
+	test_many_lines(rt);
+}
+
+} // namespace phonometrica
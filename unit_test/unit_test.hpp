@@ -0,0 +1,43 @@
+/**********************************************************************************************************************
+ *                                                                                                                    *
+ * Copyright (C) 2019-2020 Julien Eychenne <jeychenne@gmail.com>                                                      *
+ *                                                                                                                    *
+ * The contents of this file are subject to the Mozilla Public License Version 2.0 (the "License"); you may not use   *
+ * this file except in compliance with the License. You may obtain a copy of the License at                           *
+ * http://www.mozilla.org/MPL/.                                                                                       *
+ *                                                                                                                    *
+ * Created: 18/10/2026                                                                                                *
+ *                                                                                                                    *
+ * Purpose: helpers shared by the unit tests. Each test file exports a test_xxx() function which is called by main(). *
+ * Class descriptors are global, so all the tests share the same runtime.                                             *
+ *                                                                                                                    *
+ **********************************************************************************************************************/
+
+#ifndef PHONOMETRICA_UNIT_TEST_HPP
+#define PHONOMETRICA_UNIT_TEST_HPP
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <phon/runtime/runtime.hpp>
+
+namespace phonometrica {
+
+extern int failures;
+
+#define CHECK(cond) do { if (!(cond)) { fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); failures++; } } while (0)
+
+// Run a script and return the message of the error it raised, or an empty string if it succeeded.
+std::string run(Runtime &rt, const std::string &code);
+
+inline bool starts_with(const std::string &s, const char *prefix)
+{
+	return s.compare(0, strlen(prefix), prefix) == 0;
+}
+
+void test_budget(Runtime &rt);
+void test_large_scripts(Runtime &rt);
+
+} // namespace phonometrica
+
+#endif // PHONOMETRICA_UNIT_TEST_HPP